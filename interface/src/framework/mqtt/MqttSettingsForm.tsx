@@ -237,6 +237,12 @@ const MqttSettingsForm: FC = () => {
                 />
               </Grid>
             )}
+            <Grid item>
+              <BlockFormControlLabel
+                control={<Checkbox name="publish_delta" checked={data.publish_delta} onChange={updateFormValue} />}
+                label={LL.MQTT_PUBLISH_DELTA()}
+              />
+            </Grid>
           </Grid>
         )}
         {!data.publish_single && (
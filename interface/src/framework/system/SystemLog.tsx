@@ -19,6 +19,8 @@ import { updateValueDirty, useRest } from 'utils';
 
 export const LOG_EVENTSOURCE_URL = EVENT_SOURCE_ROOT + 'log';
 
+const BUFFER_SIZES = [25, 50, 75, 100, 250, 500, 1000, 2500, 5000];
+
 const LogEntryLine = styled('div')(() => ({
   color: '#bbbbbb',
   fontFamily: 'monospace',
@@ -135,6 +137,13 @@ const SystemLog: FC = () => {
       return <FormLoader onRetry={loadData} errorMessage={errorMessage} />;
     }
 
+    // only the sizes the log buffer can hold, and the current one
+    const bufferSizes = BUFFER_SIZES.filter((size) => size <= data.max_messages_limit);
+    if (!bufferSizes.includes(data.max_messages)) {
+      bufferSizes.push(data.max_messages);
+      bufferSizes.sort((a, b) => a - b);
+    }
+
     return (
       <>
         <Grid container spacing={3} direction="row" justifyContent="flex-start" alignItems="center">
@@ -168,10 +177,11 @@ const SystemLog: FC = () => {
               margin="normal"
               select
             >
-              <MenuItem value={25}>25</MenuItem>
-              <MenuItem value={50}>50</MenuItem>
-              <MenuItem value={75}>75</MenuItem>
-              <MenuItem value={100}>100</MenuItem>
+              {bufferSizes.map((size) => (
+                <MenuItem key={size} value={size}>
+                  {size}
+                </MenuItem>
+              ))}
             </TextField>
           </Grid>
           <Grid item>
@@ -238,6 +238,7 @@ const de: Translation = {
   MQTT_RESPONSE: 'Veröffentliche die Kommandoantwort als `response` Topic',
   MQTT_PUBLISH_TEXT_1: 'Veröffentliche einzelne Werte bei Veränderung als eigene Topics',
   MQTT_PUBLISH_TEXT_2: 'Veröffentliche als Kommando-Topic (ioBroker)',
+  MQTT_PUBLISH_DELTA: 'Nur geänderte Werte veröffentlichen, alle 10 Minuten alle Werte',
   MQTT_PUBLISH_TEXT_3: 'Aktiviere `MQTT Discovery`',
   MQTT_PUBLISH_TEXT_4: 'Prefix für die `Discovery`-Topics',
   MQTT_PUBLISH_TEXT_5: 'Discovery Typ',
@@ -238,6 +238,7 @@ const en: Translation = {
   MQTT_RESPONSE: 'Publish command output to a `response` topic',
   MQTT_PUBLISH_TEXT_1: 'Publish single value topics on change',
   MQTT_PUBLISH_TEXT_2: 'Publish to command topics (ioBroker)',
+  MQTT_PUBLISH_DELTA: 'Only publish changed values, with a full publish every 10 minutes',
   MQTT_PUBLISH_TEXT_3: 'Enable MQTT Discovery',
   MQTT_PUBLISH_TEXT_4: 'Prefix for the Discovery topics',
   MQTT_PUBLISH_TEXT_5: 'Discovery type',
@@ -240,6 +240,7 @@ const it: Translation = {
   MQTT_RESPONSE: 'Pubblica uscita del comando in un argomento di risposta',
   MQTT_PUBLISH_TEXT_1: 'Pubblica argomenti a valore singolo sul cambiamento',
   MQTT_PUBLISH_TEXT_2: 'Pubblica per comandare gli argomenti (ioBroker)',
+  MQTT_PUBLISH_DELTA: 'Pubblica solo i valori modificati, con una pubblicazione completa ogni 10 minuti',
   MQTT_PUBLISH_TEXT_3: 'Abilita rilevamento MQTT (Home Assistant, Domoticz)',
   MQTT_PUBLISH_TEXT_4: 'Prefisso per gli argomenti di scoperta',
   MQTT_PUBLISH_TEXT_5: 'Discovery type',
@@ -238,6 +238,7 @@ const nl: Translation = {
   MQTT_RESPONSE: 'Publiceer commando output naar een `response` topic',
   MQTT_PUBLISH_TEXT_1: 'Publiceer enkele waarde topics on change',
   MQTT_PUBLISH_TEXT_2: 'Publiceer naar commando topics (ioBroker)',
+  MQTT_PUBLISH_DELTA: 'Publiceer alleen gewijzigde waarden, met elke 10 minuten een volledige publicatie',
   MQTT_PUBLISH_TEXT_3: 'Activeer MQTT Discovery',
   MQTT_PUBLISH_TEXT_4: 'Prefix voor de Discovery topics',
   MQTT_PUBLISH_TEXT_5: 'Discovery type',
@@ -238,6 +238,7 @@ const no: Translation = {
   MQTT_RESPONSE: 'Publiser kommandoer til en `response` topic',
   MQTT_PUBLISH_TEXT_1: 'Publiser singel verdi topics ved endringer',
   MQTT_PUBLISH_TEXT_2: 'Publiser til kommando topics (ioBroker)',
+  MQTT_PUBLISH_DELTA: 'Publiser kun endrede verdier, med full publisering hvert 10. minutt',
   MQTT_PUBLISH_TEXT_3: 'Aktiver MQTT Discovery',
   MQTT_PUBLISH_TEXT_4: 'Prefiks for Discovery topics',
   MQTT_PUBLISH_TEXT_5: 'Discovery type',
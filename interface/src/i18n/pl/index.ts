@@ -238,6 +238,7 @@ const pl: BaseTranslation = {
   MQTT_RESPONSE: 'Rezultat wykonania komendy publikuj w temacie "response"',
   MQTT_PUBLISH_TEXT_1: 'Tematy z pojedynczą wartością publikuj po jej zmianie',
   MQTT_PUBLISH_TEXT_2: 'Publikuj w tematach "command" (ioBroker)',
+  MQTT_PUBLISH_DELTA: 'Publikuj tylko zmienione wartości, z pełną publikacją co 10 minut',
   MQTT_PUBLISH_TEXT_3: 'Włącz opcję "MQTT discovery"',
   MQTT_PUBLISH_TEXT_4: 'Prefiks dla "MQTT discovery"',
   MQTT_PUBLISH_TEXT_5: 'Typ "MQTT discovery"',
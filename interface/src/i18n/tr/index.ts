@@ -238,6 +238,7 @@ const tr: Translation = {
   MQTT_RESPONSE: 'Komut çıktısını bir `cevap` konusuna yayınla',
   MQTT_PUBLISH_TEXT_1: 'Değişimde tek değerli konuları yayınla',
   MQTT_PUBLISH_TEXT_2: 'Komut konularına yayınla (ioBroker)',
+  MQTT_PUBLISH_DELTA: 'Yalnızca değişen değerleri yayınla, her 10 dakikada bir tam yayın',
   MQTT_PUBLISH_TEXT_3: 'MQTT keşfi etkinleştir (Home Assistant, Domoticz)',
   MQTT_PUBLISH_TEXT_4: 'Keşif konuları için ön ek',
   MQTT_PUBLISH_TEXT_5: 'Domoticz Format',
@@ -549,6 +549,25 @@ const SettingsApplication: FC = () => {
               label={LL.ENABLE_PARASITE()}
               disabled={saving}
             />
+            <Grid container spacing={1} direction="row" justifyContent="flex-start" alignItems="flex-start">
+              <Grid item xs={12} sm={6} md={4}>
+                <ValidatedTextField
+                  fieldErrors={fieldErrors}
+                  name="dallas_budget"
+                  label="Loop time budget"
+                  InputProps={{
+                    endAdornment: <InputAdornment position="end">ms</InputAdornment>
+                  }}
+                  variant="outlined"
+                  value={numberValue(data.dallas_budget)}
+                  fullWidth
+                  type="number"
+                  onChange={updateFormValue}
+                  margin="normal"
+                  disabled={saving}
+                />
+              </Grid>
+            </Grid>
           </>
         )}
         <Typography sx={{ pt: 2 }} variant="h6" color="primary">
@@ -599,6 +618,14 @@ const SettingsApplication: FC = () => {
                 disabled={saving}
               />
             </Grid>
+            <Grid item xs={12}>
+              <BlockFormControlLabel
+                control={
+                  <Checkbox checked={data.syslog_tcp} onChange={updateFormValue} name="syslog_tcp" disabled={saving} />
+                }
+                label="TCP"
+              />
+            </Grid>
             <Grid item xs={12} sm={6}>
               <TextField
                 name="syslog_level"
@@ -7,6 +7,7 @@ export interface Settings {
   syslog_mark_interval: number;
   syslog_host: string;
   syslog_port: number;
+  syslog_tcp: boolean;
   shower_timer: boolean;
   shower_alert: boolean;
   shower_alert_coldshot: number;
@@ -16,6 +17,7 @@ export interface Settings {
   telnet_enabled: boolean;
   dallas_gpio: number;
   dallas_parasite: boolean;
+  dallas_budget: number;
   led_gpio: number;
   hide_led: boolean;
   low_clock: boolean;
@@ -94,6 +94,9 @@ export const createSettingsValidator = (settings: Settings) =>
         tx_gpio: [{ required: true, message: 'Tx GPIO is required' }, GPIO_VALIDATORS3],
         rx_gpio: [{ required: true, message: 'Rx GPIO is required' }, GPIO_VALIDATORS3]
       }),
+    ...(settings.dallas_gpio !== 0 && {
+      dallas_budget: [{ type: 'number', min: 1, max: 20, message: 'Must be between 1 and 20' }]
+    }),
     ...(settings.syslog_enabled && {
       syslog_host: [{ required: true, message: 'Host is required' }, IP_OR_HOSTNAME_VALIDATOR],
       syslog_port: [
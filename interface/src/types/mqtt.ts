@@ -45,6 +45,7 @@ export interface MqttSettings {
   send_response: boolean;
   publish_single: boolean;
   publish_single2cmd: boolean;
+  publish_delta: boolean;
   discovery_prefix: string;
   discovery_type: number;
 }
@@ -45,5 +45,6 @@ export interface LogEntry {
 export interface LogSettings {
   level: number;
   max_messages: number;
+  max_messages_limit: number;
   compact: false;
 }
@@ -10,6 +10,8 @@ the LICENSE file.
 
 #include "IPAddress.h"
 
+#include <arpa/inet.h>
+
 IPAddress::IPAddress()
 : _address(0) {
   // empty
@@ -29,4 +31,11 @@ IPAddress::operator uint32_t() {
   return _address;
 }
 
+bool IPAddress::fromString(const char* address) {
+  struct in_addr addr;
+  if (inet_pton(AF_INET, address, &addr) != 1) return false;
+  _address = ntohl(addr.s_addr);
+  return true;
+}
+
 #endif
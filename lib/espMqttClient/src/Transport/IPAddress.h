@@ -20,6 +20,7 @@ class IPAddress {
   IPAddress(uint8_t p0, uint8_t p1, uint8_t p2, uint8_t p3);
   explicit IPAddress(uint32_t address);
   operator uint32_t();
+  bool fromString(const char* address);  // added for EMS-ESP standalone
 
  protected:
   uint32_t _address;
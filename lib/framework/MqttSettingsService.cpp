@@ -245,6 +245,7 @@ void MqttSettings::read(MqttSettings & settings, JsonObject & root) {
     root["discovery_type"]          = settings.discovery_type;
     root["publish_single"]          = settings.publish_single;
     root["publish_single2cmd"]      = settings.publish_single2cmd;
+    root["publish_delta"]           = settings.publish_delta;
     root["send_response"]           = settings.send_response;
 }
 
@@ -281,6 +282,7 @@ StateUpdateResult MqttSettings::update(JsonObject & root, MqttSettings & setting
     newSettings.discovery_type     = root["discovery_type"] | EMSESP_DEFAULT_DISCOVERY_TYPE;
     newSettings.publish_single     = root["publish_single"] | EMSESP_DEFAULT_PUBLISH_SINGLE;
     newSettings.publish_single2cmd = root["publish_single2cmd"] | EMSESP_DEFAULT_PUBLISH_SINGLE2CMD;
+    newSettings.publish_delta      = root["publish_delta"] | EMSESP_DEFAULT_PUBLISH_DELTA;
     newSettings.send_response      = root["send_response"] | EMSESP_DEFAULT_SEND_RESPONSE;
     newSettings.entity_format      = root["entity_format"] | EMSESP_DEFAULT_ENTITY_FORMAT;
 
@@ -325,6 +327,15 @@ StateUpdateResult MqttSettings::update(JsonObject & root, MqttSettings & setting
         changed = true;
     }
 
+    // HA needs all values in every payload, so no delta publishing with discovery
+    if (newSettings.ha_enabled && newSettings.publish_delta) {
+        newSettings.publish_delta = false;
+    }
+
+    if (newSettings.publish_delta != settings.publish_delta) {
+        changed = true;
+    }
+
     if (newSettings.send_response != settings.send_response) {
         changed = true;
     }
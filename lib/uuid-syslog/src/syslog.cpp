@@ -67,7 +67,20 @@
 #include <lwip/nd6.h>
 #endif
 
+#if defined(ARDUINO_ARCH_ESP32)
+#include <lwip/sockets.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#endif
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <algorithm>
+#include <cerrno>
+#include <cstdarg>
 #include <list>
 #include <memory>
 #if UUID_SYSLOG_THREAD_SAFE
@@ -90,6 +103,10 @@
 #define UUID_SYSLOG_UDP_IPV6_NDP_MESSAGE_DELAY 10
 #endif
 
+#ifndef UUID_SYSLOG_TCP_RECONNECT_DELAY
+#define UUID_SYSLOG_TCP_RECONNECT_DELAY 10000
+#endif
+
 static const char __pstr__logger_name[] = "syslog";
 
 namespace uuid {
@@ -116,6 +133,7 @@ void SyslogService::remove_queued_messages(uuid::log::Level level) {
     for (auto it = log_messages_.begin(); it != log_messages_.end();) {
         if (it->content_->level > level) {
             offset++;
+            queued_bytes_ -= message_size(*it);
             it = log_messages_.erase(it);
         } else {
             it->id_ -= offset;
@@ -161,7 +179,25 @@ void SyslogService::maximum_log_messages(size_t count) {
     maximum_log_messages_ = std::max((size_t)1, count);
 
     while (log_messages_.size() > maximum_log_messages_) {
-        log_messages_.pop_front();
+        pop_message();
+    }
+}
+
+size_t SyslogService::maximum_queue_bytes() const {
+#if UUID_SYSLOG_THREAD_SAFE
+    std::lock_guard<std::mutex> lock{mutex_};
+#endif
+    return maximum_queue_bytes_;
+}
+
+void SyslogService::maximum_queue_bytes(size_t bytes) {
+#if UUID_SYSLOG_THREAD_SAFE
+    std::lock_guard<std::mutex> lock{mutex_};
+#endif
+    maximum_queue_bytes_ = bytes;
+
+    while (log_messages_.size() > 1 && queued_bytes_ > maximum_queue_bytes_) {
+        pop_message();
     }
 }
 
@@ -180,6 +216,8 @@ std::pair<IPAddress, uint16_t> SyslogService::destination() const {
 void SyslogService::destination(IPAddress ip, uint16_t port) {
     ip_   = ip;
     port_ = port;
+    tcp_close();
+    connecting_ = false;
 
     if ((uint32_t)ip_ == (uint32_t)0) {
         started_ = false;
@@ -189,6 +227,8 @@ void SyslogService::destination(IPAddress ip, uint16_t port) {
 }
 
 void SyslogService::destination(const char * host, uint16_t port) {
+    tcp_close();
+    connecting_ = false;
     if (host == nullptr || host[0] == '\0') {
         started_ = false;
         remove_queued_messages(log_level());
@@ -229,6 +269,18 @@ void SyslogService::mark_interval(unsigned long interval) {
     mark_interval_ = (uint64_t)interval * 1000;
 }
 
+bool SyslogService::tcp() const {
+    return tcp_;
+}
+
+void SyslogService::tcp(bool tcp) {
+    if (tcp != tcp_) {
+        tcp_close();
+        connecting_ = false;
+        tcp_        = tcp;
+    }
+}
+
 SyslogService::QueuedLogMessage::QueuedLogMessage(unsigned long id, std::shared_ptr<uuid::log::Message> && content)
     : id_(id)
     , content_(std::move(content)) {
@@ -255,14 +307,26 @@ SyslogService::QueuedLogMessage::QueuedLogMessage(unsigned long id, std::shared_
     }
 }
 
+size_t SyslogService::message_size(const QueuedLogMessage & message) {
+    return sizeof(QueuedLogMessage) + 2 * sizeof(void *) + sizeof(uuid::log::Message) + message.content_->text.capacity();
+}
+
+/* Mutex already locked by caller. */
+void SyslogService::pop_message() {
+    queued_bytes_ -= message_size(log_messages_.front());
+    log_messages_.pop_front();
+}
+
 /* Mutex already locked by caller. */
 void SyslogService::add_message(std::shared_ptr<uuid::log::Message> & message) {
-    if (log_messages_.size() >= maximum_log_messages_) {
-        log_messages_.pop_front();
+    log_messages_.emplace_back(log_message_id_++, std::move(message));
+    queued_bytes_ += message_size(log_messages_.back());
+
+    // the queue is limited by the heap it uses, the oldest messages are discarded first
+    while (log_messages_.size() > 1 && (log_messages_.size() > maximum_log_messages_ || queued_bytes_ > maximum_queue_bytes_)) {
+        pop_message();
         log_message_fails_++;
     }
-
-    log_messages_.emplace_back(log_message_id_++, std::move(message));
 }
 
 void SyslogService::operator<<(std::shared_ptr<uuid::log::Message> message) {
@@ -277,61 +341,20 @@ void SyslogService::loop() {
 #if UUID_SYSLOG_THREAD_SAFE
     std::unique_lock<std::mutex> lock{mutex_};
 #endif
-    size_t count = std::max((size_t)1, MAX_LOG_MESSAGES);
 
-    while (!log_messages_.empty()) {
+    if (!log_messages_.empty()) {
 #if UUID_SYSLOG_THREAD_SAFE
         lock.unlock();
 #endif
 
-        if (!can_transmit())
+        if (!can_transmit() || !transmit())
             return;
 
-#if UUID_SYSLOG_THREAD_SAFE
-        lock.lock();
-
-        if (log_messages_.empty())
-            break;
-#endif
-
-        auto message = log_messages_.front();
-
-        started_ = true;
-
-#if UUID_SYSLOG_THREAD_SAFE
-        lock.unlock();
-#endif
-
-        auto ok = transmit(message);
-        if (ok) {
-#if UUID_SYSLOG_THREAD_SAFE
-            lock.lock();
-#endif
-
-            last_message_ = last_transmit_;
-            if (!log_messages_.empty() && log_messages_.front().content_ == message.content_) {
-                log_messages_.pop_front();
-            }
-
-#if UUID_SYSLOG_THREAD_SAFE
-            lock.unlock();
-#endif
-        }
-
         ::yield();
 
 #if UUID_SYSLOG_THREAD_SAFE
         lock.lock();
 #endif
-
-        if (!ok) {
-            break;
-        }
-
-        count--;
-        if (count == 0) {
-            break;
-        }
     }
 
     if (started_ && mark_interval_ != 0 && log_messages_.empty()) {
@@ -472,7 +495,17 @@ bool SyslogService::can_transmit() {
     return true;
 }
 
-bool SyslogService::transmit(const QueuedLogMessage & message) {
+// appends to a formatted message, the buffer is always terminated and the length counts what did not fit
+static size_t append(char * buffer, size_t size, size_t len, const char * format, ...) {
+    size_t  pos = std::min(len, size - 1);
+    va_list ap;
+    va_start(ap, format);
+    int ret = vsnprintf(buffer + pos, size - pos, format, ap);
+    va_end(ap);
+    return ret < 0 ? len : len + ret;
+}
+
+size_t SyslogService::format(const QueuedLogMessage & message, char * buffer, size_t size) const {
     struct tm tm;
 
     // Changes for EMS-ESP
@@ -492,11 +525,6 @@ bool SyslogService::transmit(const QueuedLogMessage & message) {
         tzm = diff < 0 ? (0 - diff) % 60 : diff % 60;
     }
 
-    if (udp_.beginPacket(ip_, port_) != 1) {
-        last_transmit_ = uuid::get_uptime_ms();
-        return false;
-    }
-
     /*
 	 * The level is constrained to 0-7 by design in RFC 5424 because higher
 	 * severity values would be a different severity in another facility. The
@@ -513,51 +541,219 @@ bool SyslogService::transmit(const QueuedLogMessage & message) {
 	 * The maximum possible priority value does not exceed the requirement that
 	 * the PRI part MUST be 3-5 characters.
 	 */
-    udp_.printf("<%u>1 ", (uint8_t)(message.content_->facility * 8U) + std::min(7U, (unsigned int)message.content_->level));
+    size_t len = append(buffer, size, 0, "<%u>1 ", (uint8_t)(message.content_->facility * 8U) + std::min(7U, (unsigned int)message.content_->level));
 
     if (tm.tm_year != 0) {
-        // udp_.printf_P("%04u-%02u-%02uT%02u:%02u:%02u.%06luZ",
-        //               tm.tm_year + 1900,
-        //               tm.tm_mon + 1,
-        //               tm.tm_mday,
-        //               tm.tm_hour,
-        //               tm.tm_min,
-        //               tm.tm_sec,
-        //               (unsigned long)message.time_.tv_usec);
-
         // added for EMS-ESP
-        udp_.printf("%04u-%02u-%02uT%02u:%02u:%02u.%06lu%+02d:%02d",
-                    tm.tm_year + 1900,
-                    tm.tm_mon + 1,
-                    tm.tm_mday,
-                    tm.tm_hour,
-                    tm.tm_min,
-                    tm.tm_sec,
-                    (unsigned long)message.time_.tv_usec,
-                    tzh,
-                    tzm);
+        len = append(buffer,
+                     size,
+                     len,
+                     "%04u-%02u-%02uT%02u:%02u:%02u.%06lu%+02d:%02d",
+                     tm.tm_year + 1900,
+                     tm.tm_mon + 1,
+                     tm.tm_mday,
+                     tm.tm_hour,
+                     tm.tm_min,
+                     tm.tm_sec,
+                     (unsigned long)message.time_.tv_usec,
+                     tzh,
+                     tzm);
     } else {
-        udp_.print('-');
+        len = append(buffer, size, len, "-");
     }
 
-    udp_.printf(" %s %s - - - ", hostname_.c_str(), message.content_->name);
+    len = append(buffer, size, len, " %s %s - - - ", hostname_.c_str(), message.content_->name);
 
-    char id_c_str[15];
-    snprintf(id_c_str, sizeof(id_c_str), " %lu: ", message.id_);
-    std::string msgstr = uuid::log::format_timestamp_ms(message.content_->uptime_ms, 3) + ' ' + uuid::log::format_level_char(message.content_->level) + id_c_str
-                         + message.content_->text;
-    for (uint16_t i = 0; i < msgstr.length(); i++) {
-        if (msgstr.at(i) & 0x80) {
-            udp_.print("\xEF\xBB\xBF");
-            // udp_.print("<BOM>"); // marker for testing if BOM is created for udf-8
+    // mark UTF-8 text with a BOM
+    for (const char c : message.content_->text) {
+        if (c & 0x80) {
+            len = append(buffer, size, len, "\xEF\xBB\xBF");
             break;
         }
     }
-    udp_.print(msgstr.c_str());
-    bool ok = (udp_.endPacket() == 1);
+
+    // same timestamp as uuid::log::format_timestamp_ms(uptime_ms, 3), without the string
+    uint64_t t = message.content_->uptime_ms;
+    return append(buffer,
+                  size,
+                  len,
+                  "%03lu+%02u:%02u:%02u.%03u %c %lu: %s",
+                  (unsigned long)(t / 86400000ULL),
+                  (unsigned int)(t / 3600000ULL % 24),
+                  (unsigned int)(t / 60000ULL % 60),
+                  (unsigned int)(t / 1000ULL % 60),
+                  (unsigned int)(t % 1000),
+                  uuid::log::format_level_char(message.content_->level),
+                  message.id_,
+                  message.content_->text.c_str());
+}
+
+bool SyslogService::tcp_connect() {
+    if (tcp_connected_) {
+        return true;
+    }
+
+    uint64_t now = uuid::get_uptime_ms();
+    if (tcp_socket_ >= 0) {
+        // the connection is pending, check it without waiting
+        fd_set fds;
+        FD_ZERO(&fds);
+        FD_SET(tcp_socket_, &fds);
+        struct timeval tv  = {0, 0};
+        int            ret = select(tcp_socket_ + 1, nullptr, &fds, nullptr, &tv);
+        if (ret == 0) {
+            if (now - last_connect_ >= TCP_CONNECT_TIMEOUT) {
+                tcp_close();
+            }
+            return false;
+        }
+        int       err = 0;
+        socklen_t len = sizeof(err);
+        if (ret < 0 || getsockopt(tcp_socket_, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err) {
+            tcp_close();
+            return false;
+        }
+        tcp_connected_ = true;
+        return true;
+    }
+
+    if (connecting_ && now < last_connect_ + UUID_SYSLOG_TCP_RECONNECT_DELAY) {
+        return false;
+    }
+    connecting_   = true;
+    last_connect_ = now;
+
+    tcp_socket_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (tcp_socket_ < 0) {
+        return false;
+    }
+    fcntl(tcp_socket_, F_SETFL, fcntl(tcp_socket_, F_GETFL, 0) | O_NONBLOCK);
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+#if defined(ARDUINO_ARCH_ESP32)
+    addr.sin_addr.s_addr = (uint32_t)ip_; // already in network byte order
+#else
+    addr.sin_addr.s_addr = htonl((uint32_t)ip_);
+#endif
+    addr.sin_port = htons(port_);
+
+    if (connect(tcp_socket_, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+        tcp_connected_ = true;
+        return true;
+    }
+    if (errno != EINPROGRESS) {
+        tcp_close();
+    }
+    return false;
+}
+
+bool SyslogService::tcp_write() {
+    if (!tcp_connect()) {
+        return false;
+    }
+
+    ssize_t n = send(tcp_socket_, batch_ + batch_sent_, batch_used_ - batch_sent_, MSG_NOSIGNAL);
+    if (n < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            tcp_close();
+        }
+        return false;
+    }
+    batch_sent_ += n;
+    return batch_sent_ == batch_used_;
+}
+
+void SyslogService::tcp_close() {
+    if (tcp_socket_ >= 0) {
+        close(tcp_socket_);
+        tcp_socket_ = -1;
+    }
+    tcp_connected_ = false;
+    batch_sent_    = 0; // a new connection starts with a whole batch, rebuilt from the queue
+}
+
+bool SyslogService::transmit() {
+    // a partly written TCP batch is finished first, a new frame can't start in the middle of one
+    if (!tcp_ || !batch_sent_) {
+        for (size_t i = 0; i < batch_count_; i++) {
+            batch_messages_[i].reset();
+        }
+        batch_count_ = 0;
+        batch_used_  = 0;
+
+#if UUID_SYSLOG_THREAD_SAFE
+        std::lock_guard<std::mutex> lock{mutex_};
+#endif
+
+        const size_t offset = tcp_ ? TCP_FRAME_PREFIX : 0;
+        for (const auto & message : log_messages_) {
+            if (batch_count_ == MAX_BATCH_MESSAGES || batch_used_ + offset + 1 >= BATCH_BUFFER_SIZE) {
+                break;
+            }
+            size_t avail = BATCH_BUFFER_SIZE - batch_used_ - offset;
+            size_t len   = format(message, batch_ + batch_used_ + offset, avail);
+            if (len >= avail) {
+                if (batch_count_) {
+                    break; // send it with the next batch
+                }
+                len = avail - 1; // truncated
+            }
+            if (tcp_) {
+                // octet counting framing (RFC 6587): MSG-LEN SP SYSLOG-MSG
+                char   prefix[TCP_FRAME_PREFIX + 1];
+                size_t n = snprintf(prefix, sizeof(prefix), "%u ", (unsigned int)len);
+                memmove(batch_ + batch_used_ + n, batch_ + batch_used_ + offset, len);
+                memcpy(batch_ + batch_used_, prefix, n);
+                len += n;
+            }
+            batch_used_ += len;
+            batch_ends_[batch_count_]       = batch_used_;
+            batch_messages_[batch_count_++] = message.content_;
+        }
+
+        started_ = true;
+    }
+
+    // UDP sends one datagram per message (RFC 5426), TCP the whole batch in as many non-blocking writes as it takes
+    size_t done = 0;
+    if (tcp_) {
+        if (tcp_write()) {
+            done        = batch_count_;
+            batch_sent_ = 0;
+        }
+    } else {
+        size_t start = 0;
+        while (done < batch_count_) {
+            if (udp_.beginPacket(ip_, port_) != 1) {
+                break;
+            }
+            udp_.write((const uint8_t *)batch_ + start, batch_ends_[done] - start);
+            if (udp_.endPacket() != 1) {
+                break;
+            }
+            start = batch_ends_[done++];
+        }
+    }
 
     last_transmit_ = uuid::get_uptime_ms();
-    return ok;
+
+#if UUID_SYSLOG_THREAD_SAFE
+    std::lock_guard<std::mutex> lock{mutex_};
+#endif
+
+    if (done) {
+        last_message_ = last_transmit_;
+    }
+    // the batch holds the messages, so one dropped from the queue while it was sent is skipped, not mistaken for another
+    for (size_t i = 0; i < done && !log_messages_.empty(); i++) {
+        if (log_messages_.front().content_ == batch_messages_[i]) {
+            pop_message();
+        }
+    }
+
+    return done == batch_count_;
 }
 
 } // namespace syslog
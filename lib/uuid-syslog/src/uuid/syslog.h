@@ -76,9 +76,16 @@ static constexpr bool thread_safe = false;
  */
 class SyslogService : public uuid::log::Handler {
   public:
-    static constexpr size_t   MAX_LOG_MESSAGES = 50;  /*!< Maximum number of log messages to buffer before they are output. @since 1.0.0 */
+    static constexpr size_t   MAX_LOG_MESSAGES = 500; /*!< Maximum number of log messages to buffer before they are output. @since 1.0.0 */
     static constexpr uint16_t DEFAULT_PORT     = 514; /*!< Default UDP port to send messages to. @since 1.0.0 */
 
+    // added for EMS-ESP
+    static constexpr size_t   MAX_QUEUE_BYTES     = 8192; /*!< Maximum heap used by queued log messages, the oldest are discarded first. */
+    static constexpr size_t   MAX_BATCH_MESSAGES  = 16;   /*!< Maximum number of messages sent in one batch. */
+    static constexpr size_t   BATCH_BUFFER_SIZE   = 1460; /*!< Size of a batch, one TCP segment. Longer messages are truncated. */
+    static constexpr size_t   TCP_FRAME_PREFIX    = 5;    /*!< Space for the octet count and separator of a TCP frame. */
+    static constexpr uint32_t TCP_CONNECT_TIMEOUT = 5000; /*!< Timeout of a TCP connection attempt, in milliseconds. It is polled without blocking. */
+
     /**
 	 * Create a new syslog service log handler.
 	 *
@@ -197,6 +204,22 @@ class SyslogService : public uuid::log::Handler {
 	 */
     void mark_interval(unsigned long interval);
 
+    /**
+	 * added for EMS-ESP
+	 * Send messages over TCP with octet counting framing (RFC 6587)
+	 * instead of one UDP datagram per message (RFC 5426).
+	 */
+    bool tcp() const;
+    void tcp(bool tcp);
+
+    /**
+	 * added for EMS-ESP
+	 * Maximum heap used by queued log messages, defaults to
+	 * SyslogService::MAX_QUEUE_BYTES.
+	 */
+    size_t maximum_queue_bytes() const;
+    void   maximum_queue_bytes(size_t bytes);
+
     /**
 	 * Dispatch queued log messages.
 	 *
@@ -224,6 +247,9 @@ class SyslogService : public uuid::log::Handler {
     size_t queued() {
         return log_messages_.size();
     }
+    size_t queued_bytes() {
+        return queued_bytes_;
+    }
     bool started() {
         return started_;
     }
@@ -281,6 +307,18 @@ class SyslogService : public uuid::log::Handler {
 	 */
     void add_message(std::shared_ptr<uuid::log::Message> & message);
 
+    /**
+	 * added for EMS-ESP
+	 * Remove the oldest message. Mutex already locked by caller.
+	 */
+    void pop_message();
+
+    /**
+	 * added for EMS-ESP
+	 * Heap used by a queued message, including the list node.
+	 */
+    static size_t message_size(const QueuedLogMessage & message);
+
     /**
 	 * Remove messages that were queued before the log level was set.
 	 *
@@ -299,14 +337,50 @@ class SyslogService : public uuid::log::Handler {
     bool can_transmit();
 
     /**
-	 * Attempt to transmit one message to the server.
+	 * Format one message as RFC 5424.
 	 *
-	 * @param[in] message Log message to be sent.
-	 * @return True if the message was successfully set, otherwise
-	 *         false.
-	 * @since 1.0.0
+	 * @param[in] message Log message to be formatted.
+	 * @param[out] buffer Buffer for the message, it is always terminated.
+	 * @param[in] size Size of the buffer.
+	 * @return Length of the complete message, truncated if it is not
+	 *         less than size.
 	 */
-    bool transmit(const QueuedLogMessage & message);
+    size_t format(const QueuedLogMessage & message, char * buffer, size_t size) const;
+
+    /**
+	 * added for EMS-ESP
+	 * Attempt to transmit a batch of messages from the front of the queue
+	 * to the server, one datagram each over UDP or in non-blocking writes
+	 * over TCP. Sent messages are removed from the queue.
+	 *
+	 * @return True if the whole batch was sent, otherwise false.
+	 */
+    bool transmit();
+
+    /**
+	 * added for EMS-ESP
+	 * Start a non-blocking connection to the TCP server, retrying at most
+	 * every UUID_SYSLOG_TCP_RECONNECT_DELAY milliseconds, or check if the
+	 * pending one has completed.
+	 *
+	 * @return True if connected.
+	 */
+    bool tcp_connect();
+
+    /**
+	 * added for EMS-ESP
+	 * Write as much of the rest of the batch as the socket takes without
+	 * blocking.
+	 *
+	 * @return True if the whole batch has been written.
+	 */
+    bool tcp_write();
+
+    /**
+	 * added for EMS-ESP
+	 * Close the TCP connection and discard a partly written batch.
+	 */
+    void tcp_close();
 
     static uuid::log::Logger logger_; /*!< uuid::log::Logger instance for syslog services. @since 1.0.0 */
 
@@ -329,6 +403,22 @@ class SyslogService : public uuid::log::Handler {
     IPAddress     ip_;   /*!< Host to send messages to. @since 1.0.0 */
     std::string   host_; /*!< Host-IP to send messages to */
     unsigned long log_message_fails_ = 0;
+
+    // added for EMS-ESP
+    int      tcp_socket_          = -1;              /*!< Non-blocking TCP socket, if messages are sent over TCP. */
+    bool     tcp_connected_       = false;           /*!< The TCP connection has been established. */
+    bool     tcp_                 = false;           /*!< Send messages over TCP. */
+    uint64_t last_connect_        = 0;               /*!< Last TCP connection attempt. */
+    bool     connecting_          = false;           /*!< A TCP connection has been attempted. */
+    size_t   queued_bytes_        = 0;               /*!< Heap used by queued log messages. */
+    size_t   maximum_queue_bytes_ = MAX_QUEUE_BYTES; /*!< Maximum heap used by queued log messages. */
+    char     batch_[BATCH_BUFFER_SIZE];              /*!< Messages of the batch being sent. */
+    size_t   batch_count_ = 0;                       /*!< Number of messages in the batch. */
+    size_t   batch_used_  = 0;                       /*!< Length of the batch. */
+    size_t   batch_sent_  = 0;                       /*!< Bytes of the batch already written over TCP. */
+    size_t   batch_ends_[MAX_BATCH_MESSAGES];        /*!< End of each message in the batch. */
+
+    std::shared_ptr<const uuid::log::Message> batch_messages_[MAX_BATCH_MESSAGES]; /*!< Messages in the batch, removed from the queue once they are sent. */
 };
 
 } // namespace syslog
@@ -46,6 +46,15 @@ millis():
 static unsigned long __millis = 0;
 static bool          __output_pins[256];
 static int           __output_level[256];
+static bool          __input_simulated[256];
+static int           __input_level[256];
+
+struct PinInterrupt {
+    void (*handler)(void *);
+    void * arg;
+    int    mode;
+};
+static PinInterrupt __interrupts[256];
 
 std::atomic_bool exitProgram(false);
 
@@ -129,6 +138,8 @@ void digitalWrite(uint8_t pin, uint8_t value) {
 int digitalRead(uint8_t pin) {
     if (__output_pins[pin]) {
         return __output_level[pin];
+    } else if (__input_simulated[pin]) {
+        return __input_level[pin];
     } else if (pin & 1) {
         return HIGH;
     } else {
@@ -136,6 +147,25 @@ int digitalRead(uint8_t pin) {
     }
 }
 
+void attachInterruptArg(uint8_t pin, void (*handler)(void *), void * arg, int mode) {
+    __interrupts[pin] = {handler, arg, mode};
+}
+
+void detachInterrupt(uint8_t pin) {
+    __interrupts[pin] = {nullptr, nullptr, 0};
+}
+
+void simulatePinLevel(uint8_t pin, uint8_t level) {
+    int old_level            = digitalRead(pin);
+    __input_simulated[pin]   = true;
+    __input_level[pin]       = level ? HIGH : LOW;
+    const PinInterrupt & isr = __interrupts[pin];
+    if (isr.handler && old_level != __input_level[pin]
+        && (isr.mode == CHANGE || (isr.mode == RISING && __input_level[pin] == HIGH) || (isr.mode == FALLING && __input_level[pin] == LOW))) {
+        isr.handler(isr.arg);
+    }
+}
+
 uint32_t analogReadMilliVolts(uint8_t pin) {
     return 0;
 }
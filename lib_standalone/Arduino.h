@@ -38,6 +38,7 @@ typedef double double_t;
 
 #define ICACHE_FLASH_ATTR
 #define ICACHE_RAM_ATTR
+#define IRAM_ATTR
 #define os_event_t void
 #define byte uint8_t
 #define ltoa itoa
@@ -54,6 +55,10 @@ typedef double double_t;
 #define OUTPUT 1
 #define INPUT_PULLUP 2
 
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
 #define snprintf snprintf_P // to keep backwards compatibility
 
 void     pinMode(uint8_t pin, uint8_t mode);
@@ -61,6 +66,12 @@ void     digitalWrite(uint8_t pin, uint8_t value);
 int      digitalRead(uint8_t pin);
 uint32_t analogReadMilliVolts(uint8_t pin);
 
+void attachInterruptArg(uint8_t pin, void (*handler)(void *), void * arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+// drives the level of an input pin and calls its interrupt handler, to simulate pulses
+void simulatePinLevel(uint8_t pin, uint8_t level);
+
 typedef enum { ADC_0db, ADC_2_5db, ADC_6db, ADC_11db } adc_attenuation_t;
 void   analogSetPinAttenuation(uint8_t pin, adc_attenuation_t attenuation);
 void   analogSetAttenuation(adc_attenuation_t attenuation);
@@ -176,6 +187,7 @@ extern WiFiClass     WiFi;
 #include <chrono> // NOLINT [build/c++11]
 #include <thread> // NOLINT [build/c++11] for yield()
 #define millis() std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count()
+#define micros() std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count()
 #endif
 
 int64_t esp_timer_get_time();
@@ -59,8 +59,9 @@ typedef enum {
     HTTP_ANY     = 0b01111111,
 } WebRequestMethod;
 
-typedef uint8_t                   WebRequestMethodComposite;
-typedef std::function<void(void)> ArDisconnectHandler;
+typedef uint8_t                                          WebRequestMethodComposite;
+typedef std::function<void(void)>                        ArDisconnectHandler;
+typedef std::function<size_t(uint8_t *, size_t, size_t)> AwsResponseFiller;
 
 class AsyncWebServerRequest {
     friend class AsyncWebServer;
@@ -157,6 +158,14 @@ class AsyncWebServerRequest {
         return nullptr;
     }
 
+    AsyncWebServerResponse * beginResponse(const String & contentType, size_t len, AwsResponseFiller callback) {
+        return nullptr;
+    }
+
+    AsyncWebServerResponse * beginChunkedResponse(const String & contentType, AwsResponseFiller callback) {
+        return nullptr;
+    }
+
     size_t headers() const; // get header count
     size_t params() const;  // get arguments count
 };
@@ -208,6 +217,8 @@ class AsyncWebServerResponse {
   public:
     AsyncWebServerResponse();
     virtual ~AsyncWebServerResponse();
+
+    void addHeader(const String & name, const String & value){};
 };
 
 typedef std::function<void(AsyncWebServerRequest * request)> ArRequestHandlerFunction;
@@ -243,6 +254,9 @@ class AsyncEventSource : public AsyncWebHandler {
     size_t count() const {
         return 1;
     }
+    size_t avgPacketsWaiting() const {
+        return 0;
+    }
 
     void send(const char * message, const char * event = NULL, uint32_t id = 0, uint32_t reconnect = 0){};
 };
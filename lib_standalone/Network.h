@@ -5,6 +5,9 @@
 #include <functional>
 #include <IPAddress.h>
 
+#include <arpa/inet.h>
+#include <netdb.h>
+
 #define WiFiMode_t wifi_mode_t
 #define WIFI_OFF WIFI_MODE_NULL
 #define WIFI_STA WIFI_MODE_STA
@@ -159,6 +162,18 @@ class WiFiClass {
     wl_status_t status() {
         return WL_CONNECTED;
     }
+
+    int hostByName(const char * host, IPAddress & ip) {
+        struct addrinfo   hints = {};
+        struct addrinfo * res   = nullptr;
+        hints.ai_family         = AF_INET;
+        if (getaddrinfo(host, nullptr, &hints, &res) != 0 || res == nullptr) {
+            return 0;
+        }
+        ip = IPAddress(ntohl(((struct sockaddr_in *)res->ai_addr)->sin_addr.s_addr));
+        freeaddrinfo(res);
+        return 1;
+    }
 };
 
 class ETHClass {
@@ -0,0 +1,6 @@
+#ifndef WiFi_h
+#define WiFi_h
+
+#include "Arduino.h"
+
+#endif
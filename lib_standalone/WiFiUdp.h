@@ -0,0 +1,57 @@
+#ifndef WiFiUdp_h
+#define WiFiUdp_h
+
+#include "Arduino.h"
+
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// sends real datagrams, so syslog can be tested against a local listener
+class WiFiUDP : public Print {
+  public:
+    ~WiFiUDP() {
+        if (sockfd_ >= 0) {
+            ::close(sockfd_);
+        }
+    }
+
+    int beginPacket(IPAddress ip, uint16_t port) {
+        if (sockfd_ < 0) {
+            sockfd_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+            if (sockfd_ < 0) {
+                return 0;
+            }
+        }
+        memset(&host_, 0, sizeof(host_));
+        host_.sin_family      = AF_INET;
+        host_.sin_addr.s_addr = htonl((uint32_t)ip);
+        host_.sin_port        = htons(port);
+        packet_.clear();
+        return 1;
+    }
+
+    int endPacket() {
+        return ::sendto(sockfd_, packet_.data(), packet_.size(), 0, (struct sockaddr *)&host_, sizeof(host_)) == (ssize_t)packet_.size() ? 1 : 0;
+    }
+
+    size_t write(uint8_t c) override {
+        packet_.push_back(c);
+        return 1;
+    }
+
+    size_t write(const uint8_t * buffer, size_t size) override {
+        packet_.insert(packet_.end(), buffer, buffer + size);
+        return size;
+    }
+
+  private:
+    int                  sockfd_ = -1;
+    struct sockaddr_in   host_;
+    std::vector<uint8_t> packet_;
+};
+
+#endif
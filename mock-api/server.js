@@ -52,6 +52,7 @@ const LOG_SETTINGS_ENDPOINT = REST_ENDPOINT_ROOT + 'logSettings';
 log_settings = {
   level: 6,
   max_messages: 50,
+  max_messages_limit: 256,
   compact: false
 };
 
@@ -275,7 +276,8 @@ mqtt_settings = {
   discovery_type: 0,
   discovery_prefix: 'homeassistant',
   send_response: true,
-  publish_single: false
+  publish_single: false,
+  publish_delta: false
 };
 const mqtt_status = {
   enabled: true,
@@ -362,6 +364,7 @@ settings = {
   syslog_mark_interval: 0,
   syslog_host: '192.168.1.4',
   syslog_port: 514,
+  syslog_tcp: false,
   shower_timer: true,
   shower_alert: true,
   shower_alert_trigger: 7,
@@ -374,6 +377,7 @@ settings = {
   eth_clock_mode: 0,
   dallas_gpio: 3,
   dallas_parasite: false,
+  dallas_budget: 2,
   led_gpio: 2,
   hide_led: false,
   notoken_api: false,
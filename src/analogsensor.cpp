@@ -23,6 +23,30 @@ namespace emsesp {
 
 uuid::log::Logger AnalogSensor::logger_{F_(analogsensor), uuid::log::Facility::DAEMON};
 
+AnalogSensor::EdgeEvent AnalogSensor::edge_ring_[AnalogSensor::EDGE_RING_SIZE];
+std::atomic<uint8_t>    AnalogSensor::edge_head_{0};
+std::atomic<uint8_t>    AnalogSensor::edge_tail_{0};
+std::atomic<uint32_t>   AnalogSensor::edges_dropped_{0};
+
+// GPIO interrupt of the digital inputs, the argument is the GPIO
+// the time has the same base as uuid::get_uptime(), which is only updated once per loop
+static void IRAM_ATTR edge_isr(void * arg) {
+    uint8_t gpio = (uint8_t)(uintptr_t)arg;
+    AnalogSensor::edge_event(gpio, digitalRead(gpio), (uint32_t)(esp_timer_get_time() / 1000ULL));
+}
+
+// add a level change to the edge ring, called from the GPIO interrupt
+void IRAM_ATTR AnalogSensor::edge_event(const uint8_t gpio, const uint8_t level, const uint32_t time) {
+    uint8_t head = edge_head_.load(std::memory_order_relaxed);
+    uint8_t next = (head + 1) % EDGE_RING_SIZE;
+    if (next == edge_tail_.load(std::memory_order_acquire)) {
+        edges_dropped_.fetch_add(1, std::memory_order_relaxed); // full, the level is picked up again by the resync in measure()
+        return;
+    }
+    edge_ring_[head] = {time, gpio, level};
+    edge_head_.store(next, std::memory_order_release); // publish the event to process_edges()
+}
+
 void AnalogSensor::start() {
     reload(); // fetch the list of sensors from our customization service
 
@@ -67,6 +91,7 @@ void AnalogSensor::reload() {
 #if defined(EMSESP_STANDALONE)
     analog_enabled_ = true; // for local offline testing
 #endif
+    detach_edges();
     for (auto sensor : sensors_) {
         remove_ha_topic(sensor.type(), sensor.gpio());
         sensor.ha_registered = false;
@@ -160,6 +185,7 @@ void AnalogSensor::reload() {
 #endif
             sensor.polltime_ = 0;
             sensor.poll_     = digitalRead(sensor.gpio());
+            attach_edges(sensor);
             if (double_t val = EMSESP::nvs_.getDouble(sensor.name().c_str(), 0)) {
                 sensor.set_value(val);
             }
@@ -170,6 +196,7 @@ void AnalogSensor::reload() {
             sensor.polltime_      = uuid::get_uptime();
             sensor.last_polltime_ = uuid::get_uptime();
             sensor.poll_          = digitalRead(sensor.gpio());
+            attach_edges(sensor);
             sensor.set_offset(0);
             sensor.set_value(0);
             publish_sensor(sensor);
@@ -180,6 +207,7 @@ void AnalogSensor::reload() {
             sensor.set_uom(0);                            // no uom, just for safe measures
             sensor.polltime_ = 0;
             sensor.poll_     = digitalRead(sensor.gpio());
+            attach_edges(sensor);
             publish_sensor(sensor);
         } else if (sensor.type() == AnalogType::DIGITAL_OUT) {
             LOG_DEBUG("Adding analog Write sensor on GPIO %02d", sensor.gpio());
@@ -234,8 +262,10 @@ void AnalogSensor::measure() {
     static uint32_t measure_last_ = 0;
 
     // measure interval 500ms for adc sensors
+    bool resync = false;
     if (!measure_last_ || (uuid::get_uptime() - measure_last_) >= MEASURE_ANALOG_INTERVAL) {
         measure_last_ = uuid::get_uptime();
+        resync        = true;
         // go through the list of adc sensors
         for (auto & sensor : sensors_) {
             if (sensor.type() == AnalogType::ADC) {
@@ -258,49 +288,106 @@ void AnalogSensor::measure() {
             }
         }
     }
-    // poll digital io every time with debounce
-    // go through the list of digital sensors
-    for (auto & sensor : sensors_) {
-        if (sensor.type() == AnalogType::DIGITAL_IN || sensor.type() == AnalogType::COUNTER || sensor.type() == AnalogType::TIMER
-            || sensor.type() == AnalogType::RATE) {
-            auto old_value       = sensor.value(); // remember current value before reading
-            auto current_reading = digitalRead(sensor.gpio());
-            if (sensor.poll_ != current_reading) {     // check for pinchange
-                sensor.polltime_ = uuid::get_uptime(); // remember time of pinchange
-                sensor.poll_     = current_reading;
-            }
-            // debounce and check for real pinchange
-            if (uuid::get_uptime() - sensor.polltime_ >= 15 && sensor.poll_ != sensor.last_reading_) {
-                sensor.last_reading_ = sensor.poll_;
-                if (sensor.type() == AnalogType::DIGITAL_IN) {
-                    sensor.set_value(sensor.poll_);
-                } else if (!sensor.poll_) { // falling edge
-                    if (sensor.type() == AnalogType::COUNTER) {
-                        sensor.set_value(old_value + sensor.factor());
-                        // EMSESP::nvs_.putDouble(sensor.name().c_str(), sensor.value());
-                    } else if (sensor.type() == AnalogType::RATE) { // default uom: Hz (1/sec) with factor 1
-                        sensor.set_value(sensor.factor() * 1000 / (sensor.polltime_ - sensor.last_polltime_));
-                    } else if (sensor.type() == AnalogType::TIMER) { // default seconds with factor 1
-                        sensor.set_value(sensor.factor() * (sensor.polltime_ - sensor.last_polltime_) / 1000);
-                    }
-                    sensor.last_polltime_ = sensor.polltime_;
-                }
-            }
-            // see if there is a change and increment # reads
-            if (old_value != sensor.value()) {
-                sensorreads_++;
-                changed_ = true;
-                publish_sensor(sensor);
+    // process the edges captured by the GPIO interrupts, and every 500ms read the levels again
+    // in case an edge was lost because the ring was full
+    process_edges(resync);
+
+    // store counter-values only every hour to reduce flash wear
+    uint32_t hour = time(nullptr) / 3600;
+    if (hour != last_save_hour_) {
+        last_save_hour_ = hour;
+        store_counters();
+    }
+}
+
+static bool is_digital_in(const int8_t type) {
+    return type == AnalogSensor::AnalogType::DIGITAL_IN || type == AnalogSensor::AnalogType::COUNTER || type == AnalogSensor::AnalogType::TIMER
+           || type == AnalogSensor::AnalogType::RATE;
+}
+
+// capture the level changes of a digital input in the GPIO interrupt, so pulses are not missed when the loop is slow
+void AnalogSensor::attach_edges(Sensor & sensor) {
+    sensor.last_reading_ = sensor.poll_; // the level at start is the stable level
+    attachInterruptArg(sensor.gpio(), edge_isr, (void *)(uintptr_t)sensor.gpio(), CHANGE);
+}
+
+// stop the interrupts of the digital inputs before the sensors are reloaded, and drop their pending edges
+void AnalogSensor::detach_edges() {
+    for (const auto & sensor : sensors_) {
+        if (is_digital_in(sensor.type())) {
+            detachInterrupt(sensor.gpio());
+        }
+    }
+    edge_tail_.store(edge_head_.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+// process the edge events in the order they were captured, using the time of the interrupt
+// values are published once per batch instead of on every pulse
+void AnalogSensor::process_edges(const bool resync) {
+    uint8_t tail = edge_tail_.load(std::memory_order_relaxed);
+    while (tail != edge_head_.load(std::memory_order_acquire)) {
+        const EdgeEvent & event = edge_ring_[tail];
+        for (auto & sensor : sensors_) {
+            if (sensor.gpio() == event.gpio_ && is_digital_in(sensor.type())) {
+                edge(sensor, event.level_, event.time_);
+                break;
             }
         }
+        tail = (tail + 1) % EDGE_RING_SIZE;
+        edge_tail_.store(tail, std::memory_order_release); // hand the slot back to edge_event()
     }
-    // store counter-values only every hour to reduce flash wear
-    static uint8_t lastSaveHour = 0;
-    time_t         now          = time(nullptr);
-    tm *           tm_          = localtime(&now);
-    if (tm_->tm_hour != lastSaveHour) {
-        lastSaveHour = tm_->tm_hour;
-        store_counters();
+
+    uint32_t now = uuid::get_uptime();
+    for (auto & sensor : sensors_) {
+        if (!is_digital_in(sensor.type())) {
+            continue;
+        }
+        if (resync) {
+            edge(sensor, digitalRead(sensor.gpio()), now);
+        }
+        debounce(sensor, now); // the last edge is stable now
+        if (sensor.value_changed) {
+            sensor.value_changed = false;
+            changed_             = true;
+            publish_sensor(sensor);
+        }
+    }
+}
+
+// a level change of a digital input at the given time
+void AnalogSensor::edge(Sensor & sensor, const int level, const uint32_t time) {
+    debounce(sensor, time); // the level before this edge may have been stable long enough
+    if (level != sensor.poll_) {
+        sensor.poll_     = level;
+        sensor.polltime_ = time;
+        edges_++;
+    }
+}
+
+// a level is taken as a real pinchange when it was stable for the debounce time
+// events can be older than the last resync, so the time difference is signed
+void AnalogSensor::debounce(Sensor & sensor, const uint32_t time) {
+    if ((int32_t)(time - sensor.polltime_) < (int32_t)DEBOUNCE_TIME || sensor.poll_ == sensor.last_reading_) {
+        return;
+    }
+    auto old_value       = sensor.value(); // remember current value
+    sensor.last_reading_ = sensor.poll_;
+    if (sensor.type() == AnalogType::DIGITAL_IN) {
+        sensor.set_value(sensor.poll_);
+    } else if (!sensor.poll_) { // falling edge
+        if (sensor.type() == AnalogType::COUNTER) {
+            sensor.set_value(old_value + sensor.factor());
+        } else if (sensor.type() == AnalogType::RATE) { // default uom: Hz (1/sec) with factor 1
+            sensor.set_value(sensor.factor() * 1000 / (sensor.polltime_ - sensor.last_polltime_));
+        } else if (sensor.type() == AnalogType::TIMER) { // default seconds with factor 1
+            sensor.set_value(sensor.factor() * (sensor.polltime_ - sensor.last_polltime_) / 1000);
+        }
+        sensor.last_polltime_ = sensor.polltime_;
+    }
+    // see if there is a change and increment # reads
+    if (old_value != sensor.value()) {
+        sensorreads_++;
+        sensor.value_changed = true;
     }
 }
 
@@ -829,6 +916,23 @@ void AnalogSensor::test() {
     sensors_.emplace_back(37, "test13", 0, 0, 0, AnalogType::DIGITAL_IN);
     sensors_.back().set_value(13);
 }
+
+#if defined(EMSESP_STANDALONE)
+// simulate pulses on a digital input, each with a short bounce on the falling edge
+// the loop runs every 10ms, in standalone esp_timer_get_time() counts the delays as microseconds
+void AnalogSensor::test_pulses(const uint8_t gpio, const uint16_t count, const uint32_t period) {
+    for (uint16_t i = 0; i < count; i++) {
+        for (uint32_t t = 0; t < period; t++) {
+            simulatePinLevel(gpio, t >= period / 2 || (t >= 1 && t < 3) ? HIGH : LOW);
+            delay(1000);
+            if (t % 10 == 0) {
+                uuid::loop();
+                loop();
+            }
+        }
+    }
+}
+#endif
 #endif
 
 } // namespace emsesp
\ No newline at end of file
@@ -25,6 +25,8 @@
 
 #include <uuid/log.h>
 
+#include <atomic>
+
 namespace emsesp {
 
 class AnalogSensor {
@@ -85,13 +87,14 @@ class AnalogSensor {
         }
 
         bool ha_registered = false;
+        bool value_changed = false; // set by an edge, published after the batch
 
         uint16_t analog_        = 0; // ADC - average value
         uint32_t sum_           = 0; // ADC - rolling sum
         uint16_t last_reading_  = 0; // IO COUNTER & ADC - last reading
         uint16_t count_         = 0; // counter raw counts
-        uint32_t polltime_      = 0; // digital IO & COUNTER debounce time
-        int      poll_          = 0;
+        uint32_t polltime_      = 0; // digital IO & COUNTER time of the last edge, for debounce
+        int      poll_          = 0; // digital IO & COUNTER level after the last edge
         uint32_t last_polltime_ = 0; // for timer
 
       private:
@@ -140,6 +143,14 @@ class AnalogSensor {
         return sensorfails_;
     }
 
+    uint32_t edges() const {
+        return edges_;
+    }
+
+    uint32_t edges_dropped() const {
+        return edges_dropped_;
+    }
+
     bool analog_enabled() const {
         return (analog_enabled_);
     }
@@ -156,19 +167,38 @@ class AnalogSensor {
     bool get_value_info(JsonObject & output, const char * cmd, const int8_t id) const;
     void store_counters();
 
+    static void edge_event(const uint8_t gpio, const uint8_t level, const uint32_t time);
+
 #if defined(EMSESP_TEST)
     void test();
+#if defined(EMSESP_STANDALONE)
+    void test_pulses(const uint8_t gpio, const uint16_t count, const uint32_t period);
+#endif
 #endif
 
   private:
     static constexpr uint8_t  MAX_SENSORS             = 20;
     static constexpr uint32_t MEASURE_ANALOG_INTERVAL = 500;
+    static constexpr uint32_t DEBOUNCE_TIME           = 15; // ms a level must be stable to count as an edge
+    static constexpr uint8_t  EDGE_RING_SIZE          = 64; // one slot is always kept free
+
+    // a level change of a digital input, captured in the GPIO interrupt
+    struct EdgeEvent {
+        uint32_t time_;
+        uint8_t  gpio_;
+        uint8_t  level_;
+    };
 
     static uuid::log::Logger logger_;
 
     void remove_ha_topic(const int8_t type, const uint8_t id) const;
     bool command_setvalue(const char * value, const int8_t gpio);
     void measure();
+    void process_edges(const bool resync);
+    void edge(Sensor & sensor, const int level, const uint32_t time);
+    void debounce(Sensor & sensor, const uint32_t time);
+    void attach_edges(Sensor & sensor);
+    void detach_edges();
     bool command_info(const char * value, const int8_t id, JsonObject & output) const;
     bool command_commands(const char * value, const int8_t id, JsonObject & output);
 
@@ -178,6 +208,16 @@ class AnalogSensor {
     bool     changed_     = false;
     uint32_t sensorfails_ = 0;
     uint32_t sensorreads_ = 0;
+    uint32_t edges_       = 0; // # edge events processed
+
+    // the edge events, a single-producer/single-consumer ring without locks or allocations
+    // edge_event() is called from the GPIO interrupt and only writes edge_head_, process_edges() runs in the main loop and only writes edge_tail_
+    static EdgeEvent             edge_ring_[EDGE_RING_SIZE];
+    static std::atomic<uint8_t>  edge_head_;
+    static std::atomic<uint8_t>  edge_tail_;
+    static std::atomic<uint32_t> edges_dropped_; // # edge events dropped because the ring was full
+
+    uint32_t last_save_hour_ = 0;
 };
 
 } // namespace emsesp
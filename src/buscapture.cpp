@@ -0,0 +1,177 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020-2023  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "emsesp.h"
+
+namespace emsesp {
+
+uuid::log::Logger BusCapture::logger_{F_(capture), uuid::log::Facility::CONSOLE};
+
+void BusCapture::push(const uint8_t value) {
+    buffer_[head_] = value;
+    head_          = (head_ + 1) % CAPTURE_SIZE;
+    used_++;
+}
+
+// size in bytes of the oldest record in the buffer
+size_t BusCapture::oldest_size() const {
+    size_t size = 1; // header
+    while (peek(tail_ + size++) & 0x80) {
+        // skip the varint time
+    }
+    return size + (peek(tail_) & CAPTURE_LENGTH_MASK);
+}
+
+// add a frame to the ring buffer, called from the UART task when the frame arrives
+// the time is taken here, the uptime of the main loop is only updated once per loop
+// length includes the CRC
+void BusCapture::record(const uint8_t * data, const uint8_t length, const bool crc_ok) {
+    if (length == 0 || length > CAPTURE_LENGTH_MASK) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    uint32_t now   = millis();
+    uint32_t delta = records_ ? now - last_time_ : 0;
+    last_time_     = now;
+
+    uint8_t varint[5];
+    uint8_t varint_len = 0;
+    do {
+        varint[varint_len] = delta & 0x7F;
+        delta >>= 7;
+        if (delta) {
+            varint[varint_len] |= 0x80;
+        }
+        varint_len++;
+    } while (delta);
+
+    // make room by dropping the oldest records
+    size_t size = 1 + varint_len + length;
+    while (CAPTURE_SIZE - used_ < size) {
+        size_t oldest = oldest_size();
+        tail_         = (tail_ + oldest) % CAPTURE_SIZE;
+        used_ -= oldest;
+        records_--;
+    }
+
+    push(length | (crc_ok ? 0 : CAPTURE_CRC_ERROR));
+    for (uint8_t i = 0; i < varint_len; i++) {
+        push(varint[i]);
+    }
+    for (uint8_t i = 0; i < length; i++) {
+        push(data[i]);
+    }
+    records_++;
+    recorded_++;
+}
+
+void BusCapture::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    head_     = 0;
+    tail_     = 0;
+    used_     = 0;
+    records_  = 0;
+    recorded_ = 0;
+}
+
+// returns the capture as a binary blob with header, oldest record first
+// the blob is allocated before taking the lock, so record() on the UART task only waits for the copy
+std::vector<uint8_t> BusCapture::snapshot() {
+    std::vector<uint8_t> capture(CAPTURE_HEADER_SIZE + CAPTURE_SIZE);
+    capture[0] = 'E';
+    capture[1] = 'M';
+    capture[2] = 'S';
+    capture[3] = 'C';
+    capture[4] = CAPTURE_VERSION;
+
+    size_t used;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (uint8_t i = 0; i < 4; i++) {
+            capture[5 + i] = (last_time_ >> (8 * i)) & 0xFF;
+        }
+        used     = used_;
+        size_t n = std::min(used, CAPTURE_SIZE - tail_);
+        memcpy(capture.data() + CAPTURE_HEADER_SIZE, buffer_ + tail_, n);
+        memcpy(capture.data() + CAPTURE_HEADER_SIZE + n, buffer_, used - n);
+    }
+    capture.resize(CAPTURE_HEADER_SIZE + used);
+    return capture;
+}
+
+// write the capture to the filesystem, in standalone to the current directory
+bool BusCapture::save() {
+    auto capture = snapshot();
+#ifndef EMSESP_STANDALONE
+    File file = LittleFS.open(EMSESP_CAPTURE_FILE, "w");
+    if (!file) {
+        LOG_ERROR("Failed to open %s for writing", EMSESP_CAPTURE_FILE);
+        return false;
+    }
+    bool ok = file.write(capture.data(), capture.size()) == capture.size();
+    file.close();
+#else
+    FILE * file = fopen(EMSESP_CAPTURE_FILE + 1, "wb");
+    if (file == nullptr) {
+        LOG_ERROR("Failed to open %s for writing", EMSESP_CAPTURE_FILE + 1);
+        return false;
+    }
+    bool ok = fwrite(capture.data(), 1, capture.size(), file) == capture.size();
+    fclose(file);
+#endif
+    if (ok) {
+        LOG_INFO("Bus capture with %u telegrams saved to %s", records_, EMSESP_CAPTURE_FILE);
+    } else {
+        LOG_ERROR("Failed to write %s", EMSESP_CAPTURE_FILE);
+    }
+    return ok;
+}
+
+// read back an exported capture and call f for each frame, oldest first
+// returns false if the data is not a capture or is truncated
+bool BusCapture::parse(const uint8_t * data, const size_t length, const capture_function_p & f) {
+    if (length < CAPTURE_HEADER_SIZE || memcmp(data, "EMSC", 4) != 0 || data[4] != CAPTURE_VERSION) {
+        return false;
+    }
+
+    size_t pos = CAPTURE_HEADER_SIZE;
+    while (pos < length) {
+        uint8_t  header = data[pos++];
+        uint32_t delta  = 0;
+        uint8_t  shift  = 0;
+        while (pos < length) {
+            uint8_t b = data[pos++];
+            delta |= (uint32_t)(b & 0x7F) << shift;
+            shift += 7;
+            if (!(b & 0x80)) {
+                break;
+            }
+        }
+        uint8_t frame_length = header & CAPTURE_LENGTH_MASK;
+        if (pos + frame_length > length) {
+            return false;
+        }
+        f(delta, data + pos, frame_length, !(header & CAPTURE_CRC_ERROR));
+        pos += frame_length;
+    }
+    return true;
+}
+
+} // namespace emsesp
@@ -0,0 +1,88 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020-2023  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMSESP_BUSCAPTURE_H
+#define EMSESP_BUSCAPTURE_H
+
+#include <Arduino.h>
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include <uuid/log.h>
+
+#define EMSESP_CAPTURE_FILE "/buscapture.bin"
+
+namespace emsesp {
+
+// Black box recorder of the raw Rx frames, kept in a fixed size RAM ring buffer.
+// Each record is a header byte (bits 0-5 frame length, bit 7 CRC error), the time since the previous
+// record in ms as a varint and the frame itself including the CRC. Oldest records are dropped when full.
+// An exported capture starts with "EMSC", the format version and the uptime in ms of the last record (uint32 LE).
+class BusCapture {
+  public:
+    static constexpr size_t  CAPTURE_SIZE        = 4096; // bytes, room for about 250 telegrams
+    static constexpr uint8_t CAPTURE_VERSION     = 1;
+    static constexpr uint8_t CAPTURE_HEADER_SIZE = 9;
+    static constexpr uint8_t CAPTURE_CRC_ERROR   = 0x80;
+    static constexpr uint8_t CAPTURE_LENGTH_MASK = 0x3F;
+
+    using capture_function_p = std::function<void(const uint32_t delta, const uint8_t * frame, const uint8_t length, const bool crc_ok)>;
+
+    void                 record(const uint8_t * data, const uint8_t length, const bool crc_ok);
+    void                 clear();
+    std::vector<uint8_t> snapshot();
+    bool                 save();
+
+    static bool parse(const uint8_t * data, const size_t length, const capture_function_p & f);
+
+    uint32_t records() const {
+        return records_;
+    }
+
+    uint32_t recorded() const {
+        return recorded_;
+    }
+
+    size_t used() const {
+        return used_;
+    }
+
+  private:
+    static uuid::log::Logger logger_;
+
+    uint8_t peek(const size_t pos) const {
+        return buffer_[pos % CAPTURE_SIZE];
+    }
+    void   push(const uint8_t value);
+    size_t oldest_size() const;
+
+    uint8_t    buffer_[CAPTURE_SIZE];
+    size_t     head_      = 0; // where the next record is written
+    size_t     tail_      = 0; // start of the oldest record
+    size_t     used_      = 0; // bytes in use
+    uint32_t   records_   = 0; // records in the buffer
+    uint32_t   recorded_  = 0; // records since start, including dropped ones
+    uint32_t   last_time_ = 0; // millis() of the last record
+    std::mutex mutex_;         // the web download runs in another task
+};
+
+} // namespace emsesp
+
+#endif
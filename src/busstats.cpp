@@ -0,0 +1,205 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020-2023  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "emsesp.h"
+
+namespace emsesp {
+
+// upper limits of the histogram buckets in ms, the last bucket has no limit
+const uint16_t BusStats::bucket_limits_[NUM_BUCKETS - 1] = {10, 20, 50, 100, 200, 500, 1000};
+
+void BusStats::Histogram::add(const uint32_t ms) {
+    uint8_t i = 0;
+    while (i < NUM_BUCKETS - 1 && ms >= bucket_limits_[i]) {
+        i++;
+    }
+    count_[i]++;
+    total_++;
+    sum_ += ms;
+    if (ms > max_) {
+        max_ = ms;
+    }
+}
+
+void BusStats::Histogram::output(JsonObject & json) const {
+    json["count"] = total_;
+    json["avg"]   = avg();
+    json["max"]   = max_;
+    JsonArray buckets = json.createNestedArray("buckets");
+    for (uint8_t i = 0; i < NUM_BUCKETS; i++) {
+        buckets.add(count_[i]);
+    }
+}
+
+// a Tx telegram was sent to the UART, start timing until the reply
+void BusStats::tx_sent(const uint8_t operation, const uint8_t dest, const uint32_t queue_wait) {
+    queue_wait_.add(queue_wait);
+    tx_time_ = millis();
+    tx_dest_ = dest & 0x7F;
+    tx_op_   = operation;
+}
+
+// the reply to the last read or the ack of the last write was received
+void BusStats::tx_done() {
+    if (!tx_time_) {
+        return;
+    }
+    uint32_t latency = millis() - tx_time_;
+    tx_time_         = 0;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    DeviceLatency *             device = nullptr;
+    for (auto & d : devices_) {
+        if (d.device_id_ == tx_dest_) {
+            device = &d;
+            break;
+        }
+    }
+    if (device == nullptr) {
+        devices_.emplace_back();
+        device             = &devices_.back();
+        device->device_id_ = tx_dest_;
+    }
+    if (tx_op_ == Telegram::Operation::TX_WRITE) {
+        device->write_.add(latency);
+    } else {
+        device->read_.add(latency);
+    }
+}
+
+void BusStats::tx_retry(const uint16_t type_id) {
+    tx_time_ = 0;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto & r : retries_) {
+        if (r.type_id_ == type_id) {
+            r.retries_++;
+            return;
+        }
+    }
+    retries_.push_back({type_id, 1});
+}
+
+// called for every frame on the bus, including polls and our own echo
+void BusStats::rx_frame(const uint8_t length) {
+    uint32_t now = millis();
+    bus_bytes_ += length + 1; // the break takes about as long as a byte
+    if (now - window_time_ >= OCCUPANCY_WINDOW) {
+        // each byte is 10 bits at 9600 baud
+        uint32_t busy_ms = bus_bytes_ * 10000 / 9600;
+        occupancy_       = window_time_ ? std::min((uint32_t)100, busy_ms * 100 / (now - window_time_)) : 0;
+        bus_bytes_       = 0;
+        window_time_     = now;
+    }
+}
+
+uint32_t BusStats::read_latency() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t                    sum   = 0;
+    uint32_t                    total = 0;
+    for (const auto & d : devices_) {
+        sum += d.read_.sum_;
+        total += d.read_.total_;
+    }
+    return total ? sum / total : 0;
+}
+
+uint32_t BusStats::write_latency() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t                    sum   = 0;
+    uint32_t                    total = 0;
+    for (const auto & d : devices_) {
+        sum += d.write_.sum_;
+        total += d.write_.total_;
+    }
+    return total ? sum / total : 0;
+}
+
+// name of the device like in pretty_telegram(), or its hex id
+static std::string device_name(const uint8_t device_id) {
+    char name[30];
+    snprintf(name, sizeof(name), "0x%02X", device_id);
+    for (const auto & emsdevice : EMSESP::emsdevices) {
+        if (emsdevice && emsdevice->is_device_id(device_id)) {
+            snprintf(name, sizeof(name), "%s(0x%02X)", emsdevice->device_type_name(), device_id);
+            break;
+        }
+    }
+    return name;
+}
+
+static void show_histogram(uuid::console::Shell & shell, const char * name, const BusStats::Histogram & h) {
+    if (!h.total_) {
+        return;
+    }
+    shell.printf("  %-20s %6d %6d %6d ", name, h.total_, h.avg(), h.max_);
+    for (uint8_t i = 0; i < BusStats::NUM_BUCKETS; i++) {
+        shell.printf(" %5d", h.count_[i]);
+    }
+    shell.println();
+}
+
+void BusStats::show(uuid::console::Shell & shell) const {
+    shell.printfln("  Bus occupancy: %d%%", occupancy_);
+    if (!queue_wait_.total_) {
+        return; // nothing sent yet
+    }
+    shell.printfln("  Tx timing (ms):           count    avg    max    <10   <20   <50  <100  <200  <500   <1s   >1s");
+    show_histogram(shell, "queue wait", queue_wait_);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto & d : devices_) {
+        std::string name = device_name(d.device_id_);
+        show_histogram(shell, (name + " read").c_str(), d.read_);
+        show_histogram(shell, (name + " write").c_str(), d.write_);
+    }
+    if (!retries_.empty()) {
+        shell.printf("  Tx retries per type ID:");
+        for (const auto & r : retries_) {
+            shell.printf(" 0x%02X:%d", r.type_id_, r.retries_);
+        }
+        shell.println();
+    }
+}
+
+// full statistics as json, for the system busstats command
+void BusStats::output(JsonObject & json) const {
+    json["occupancy"] = occupancy_;
+    JsonObject wait   = json.createNestedObject("queue wait");
+    queue_wait_.output(wait);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    JsonObject                  latency = json.createNestedObject("latency");
+    for (const auto & d : devices_) {
+        JsonObject device = latency.createNestedObject(device_name(d.device_id_));
+        if (d.read_.total_) {
+            JsonObject read = device.createNestedObject("read");
+            d.read_.output(read);
+        }
+        if (d.write_.total_) {
+            JsonObject write = device.createNestedObject("write");
+            d.write_.output(write);
+        }
+    }
+    JsonObject retries = json.createNestedObject("retries");
+    for (const auto & r : retries_) {
+        retries[Helpers::hextoa(r.type_id_, true)] = r.retries_;
+    }
+}
+
+} // namespace emsesp
@@ -0,0 +1,98 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020-2023  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMSESP_BUSSTATS_H
+#define EMSESP_BUSSTATS_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#include <mutex>
+#include <vector>
+
+#include <uuid/console.h>
+
+namespace emsesp {
+
+// Tx timing and bus load, measured in the UART task
+// latencies are from sending a Tx telegram to the reply of a read or the ack of a write, per destination device
+// bus occupancy is the time the bus carried data (10 bits per byte at 9600 baud, plus the break) in the last minute
+class BusStats {
+  public:
+    static constexpr uint8_t  NUM_BUCKETS      = 8;     // <10, <20, <50, <100, <200, <500, <1000 and >=1000 ms
+    static constexpr uint32_t OCCUPANCY_WINDOW = 60000; // ms
+
+    struct Histogram {
+        uint32_t count_[NUM_BUCKETS] = {};
+        uint32_t total_              = 0;
+        uint32_t sum_                = 0; // ms
+        uint32_t max_                = 0; // ms
+
+        void     add(const uint32_t ms);
+        uint32_t avg() const {
+            return total_ ? sum_ / total_ : 0;
+        }
+        void output(JsonObject & json) const;
+    };
+
+    void tx_sent(const uint8_t operation, const uint8_t dest, const uint32_t queue_wait);
+    void tx_done();
+    void tx_retry(const uint16_t type_id);
+    void rx_frame(const uint8_t length);
+
+    uint8_t occupancy() const {
+        return occupancy_;
+    }
+    const Histogram & queue_wait() const {
+        return queue_wait_;
+    }
+    uint32_t read_latency() const;
+    uint32_t write_latency() const;
+
+    void show(uuid::console::Shell & shell) const;
+    void output(JsonObject & json) const;
+
+  private:
+    struct DeviceLatency {
+        uint8_t   device_id_;
+        Histogram read_;
+        Histogram write_;
+    };
+
+    struct TypeRetries {
+        uint16_t type_id_;
+        uint32_t retries_;
+    };
+
+    static const uint16_t bucket_limits_[NUM_BUCKETS - 1];
+
+    Histogram                  queue_wait_;      // time in the Tx queue
+    std::vector<DeviceLatency> devices_;         // one for each destination we sent to
+    std::vector<TypeRetries>   retries_;         // per telegram type
+    uint32_t                   tx_time_     = 0; // millis() when the last Tx was sent, 0 if not waiting
+    uint8_t                    tx_dest_     = 0;
+    uint8_t                    tx_op_       = 0;
+    uint32_t                   bus_bytes_   = 0; // in the current window
+    uint32_t                   window_time_ = 0; // start of the current window
+    uint8_t                    occupancy_   = 0; // % of the last full window
+    mutable std::mutex         mutex_;           // the lists grow in the UART task and are shown from the main loop
+};
+
+} // namespace emsesp
+
+#endif
@@ -25,6 +25,7 @@ namespace emsesp {
 uuid::log::Logger Command::logger_{F_(command), uuid::log::Facility::DAEMON};
 
 std::vector<Command::CmdFunction> Command::cmdfunctions_;
+std::vector<Command::CmdIndex>    Command::cmd_index_;
 
 // takes a path and a json body, parses the data and calls the command
 // the path is leading so if duplicate keys are in the input JSON it will be ignored
@@ -227,35 +228,29 @@ const char * Command::parse_command_string(const char * command, int8_t & id) {
         return nullptr;
     }
 
-    // convert cmd to lowercase and compare
-    char * lowerCmd = strdup(command);
-    for (char * p = lowerCmd; *p; p++) {
-        *p = tolower(*p);
-    }
-
-    // check prefix and valid number range, also check 'id'
-    if (!strncmp(lowerCmd, "hc", 2) && command[2] >= '1' && command[2] <= '8') {
+    // check prefix (case insensitive) and valid number range, also check 'id'
+    if (!strncasecmp(command, "hc", 2) && command[2] >= '1' && command[2] <= '8') {
         id = command[2] - '0';
         command += 3;
-    } else if (!strncmp(lowerCmd, "wwc", 3) && command[3] == '1' && command[4] == '0') {
+    } else if (!strncasecmp(command, "wwc", 3) && command[3] == '1' && command[4] == '0') {
         id = DeviceValueTAG::TAG_WWC10 - DeviceValueTAG::TAG_HC1 + 1; //18;
         command += 5;
-    } else if (!strncmp(lowerCmd, "wwc", 3) && command[3] >= '1' && command[3] <= '9') {
+    } else if (!strncasecmp(command, "wwc", 3) && command[3] >= '1' && command[3] <= '9') {
         id = command[3] - '1' + DeviceValueTAG::TAG_WWC1 - DeviceValueTAG::TAG_HC1 + 1; //9;
         command += 4;
-    } else if (!strncmp(lowerCmd, "id", 2) && command[2] == '1' && command[3] >= '0' && command[3] <= '9') {
+    } else if (!strncasecmp(command, "id", 2) && command[2] == '1' && command[3] >= '0' && command[3] <= '9') {
         id = command[3] - '0' + 10;
         command += 4;
-    } else if (!strncmp(lowerCmd, "id", 2) && command[2] >= '1' && command[2] <= '9') {
+    } else if (!strncasecmp(command, "id", 2) && command[2] >= '1' && command[2] <= '9') {
         id = command[2] - '0';
         command += 3;
-    } else if (!strncmp(lowerCmd, "ahs", 3) && command[3] >= '1' && command[3] <= '1') { // only ahs1 for now
-        id = command[3] - '1' + DeviceValueTAG::TAG_AHS1 - DeviceValueTAG::TAG_HC1 + 1;  // 19;
+    } else if (!strncasecmp(command, "ahs", 3) && command[3] >= '1' && command[3] <= '1') { // only ahs1 for now
+        id = command[3] - '1' + DeviceValueTAG::TAG_AHS1 - DeviceValueTAG::TAG_HC1 + 1;     // 19;
         command += 4;
-    } else if (!strncmp(lowerCmd, "hs", 2) && command[2] == '1' && command[3] >= '0' && command[3] <= '6') {
+    } else if (!strncasecmp(command, "hs", 2) && command[2] == '1' && command[3] >= '0' && command[3] <= '6') {
         id = command[3] - '0' + DeviceValueTAG::TAG_HS10 - DeviceValueTAG::TAG_HC1 + 1; //29;
         command += 4;
-    } else if (!strncmp(lowerCmd, "hs", 2) && command[2] >= '1' && command[2] <= '9') {
+    } else if (!strncasecmp(command, "hs", 2) && command[2] >= '1' && command[2] <= '9') {
         id = command[2] - '1' + DeviceValueTAG::TAG_HS1 - DeviceValueTAG::TAG_HC1 + 1; //20;
         command += 3;
     }
@@ -265,8 +260,6 @@ const char * Command::parse_command_string(const char * command, int8_t & id) {
         command++;
     }
 
-    free(lowerCmd);
-
     // return null for empty command
     if (command[0] == '\0') {
         return nullptr;
@@ -380,6 +373,7 @@ void Command::add(const uint8_t device_type, const uint8_t device_id, const char
     }
 
     cmdfunctions_.emplace_back(device_type, device_id, flags, cmd, cb, nullptr, description); // callback for json is nullptr
+    add_index(cmdfunctions_.size() - 1);
 }
 
 // add a command with no json output
@@ -396,6 +390,23 @@ void Command::add(const uint8_t device_type, const char * cmd, const cmd_json_fu
     }
 
     cmdfunctions_.emplace_back(device_type, 0, flags, cmd, nullptr, cb, description); // callback for json is included
+    add_index(cmdfunctions_.size() - 1);
+}
+
+// FNV-1a hash of the device type and the command name, not case sensitive
+uint32_t Command::cmd_hash(const uint8_t device_type, const char * cmd) {
+    uint32_t hash = (2166136261UL ^ device_type) * 16777619UL;
+    while (*cmd) {
+        hash = (hash ^ (uint8_t)tolower((uint8_t)*cmd++)) * 16777619UL;
+    }
+    return hash;
+}
+
+// insert a command into the index, after any entries with the same hash
+void Command::add_index(const uint16_t pos) {
+    CmdIndex entry{cmd_hash(cmdfunctions_[pos].device_type_, cmdfunctions_[pos].cmd_), pos};
+    auto     it = std::upper_bound(cmd_index_.begin(), cmd_index_.end(), entry, [](const CmdIndex & a, const CmdIndex & b) { return a.hash_ < b.hash_; });
+    cmd_index_.insert(it, entry);
 }
 
 // see if a command exists for that device type
@@ -405,8 +416,11 @@ Command::CmdFunction * Command::find_command(const uint8_t device_type, const ui
         return nullptr;
     }
 
-    for (auto & cf : cmdfunctions_) {
-        if (Helpers::toLower(cmd) == Helpers::toLower(cf.cmd_) && (cf.device_type_ == device_type) && (!device_id || cf.device_id_ == device_id)) {
+    CmdIndex key{cmd_hash(device_type, cmd), 0};
+    auto it = std::lower_bound(cmd_index_.begin(), cmd_index_.end(), key, [](const CmdIndex & a, const CmdIndex & b) { return a.hash_ < b.hash_; });
+    for (; it != cmd_index_.end() && it->hash_ == key.hash_; ++it) {
+        auto & cf = cmdfunctions_[it->pos_];
+        if ((cf.device_type_ == device_type) && (!device_id || cf.device_id_ == device_id) && !strcasecmp(cmd, cf.cmd_)) {
             return &cf;
         }
     }
@@ -415,16 +429,19 @@ Command::CmdFunction * Command::find_command(const uint8_t device_type, const ui
 }
 
 void Command::erase_command(const uint8_t device_type, const char * cmd) {
-    if ((cmd == nullptr) || (strlen(cmd) == 0) || (cmdfunctions_.empty())) {
+    auto cf = find_command(device_type, 0, cmd);
+    if (cf == nullptr) {
         return;
     }
-    auto it = cmdfunctions_.begin();
-    for (auto & cf : cmdfunctions_) {
-        if (Helpers::toLower(cmd) == Helpers::toLower(cf.cmd_) && (cf.device_type_ == device_type)) {
-            cmdfunctions_.erase(it);
-            return;
+
+    // drop its index entry and shift down the positions after the erased command, the order of the index stays the same
+    uint16_t pos = cf - cmdfunctions_.data();
+    cmdfunctions_.erase(cmdfunctions_.begin() + pos);
+    cmd_index_.erase(std::remove_if(cmd_index_.begin(), cmd_index_.end(), [pos](const CmdIndex & e) { return e.pos_ == pos; }), cmd_index_.end());
+    for (auto & entry : cmd_index_) {
+        if (entry.pos_ > pos) {
+            entry.pos_--;
         }
-        it++;
     }
 }
 
@@ -142,6 +142,17 @@ class Command {
 
     static std::vector<CmdFunction> cmdfunctions_; // the list of commands
 
+    // index of cmdfunctions_ sorted by the hash of device type and lowercase command name
+    // entries with the same hash stay in registration order, so a lookup returns the first match like the list scan did
+    struct CmdIndex {
+        uint32_t hash_;
+        uint16_t pos_; // position in cmdfunctions_
+    };
+    static std::vector<CmdIndex> cmd_index_;
+
+    static uint32_t cmd_hash(const uint8_t device_type, const char * cmd);
+    static void     add_index(const uint16_t pos);
+
     inline static uint8_t message(uint8_t error_code, const char * message, const JsonObject & output) {
         output.clear();
         output["message"] = message;
@@ -52,6 +52,11 @@ using string_vector = std::vector<const char *>;
 #define F_(string_name) (__pstr__##string_name)
 #define FL_(list_name) (__pstr__L_##list_name)
 
+#if defined(EMSESP_TEST) || defined(EMSESP_EN_ONLY) || defined(EMSESP_DE_ONLY)
+// only one language is compiled in, translations are always the first word of the list
+#define EMSESP_SINGLE_LANGUAGE
+#endif
+
 #if defined(EMSESP_TEST) || defined(EMSESP_EN_ONLY)
 // In testing just take one language (en) to save on Flash space
 #define MAKE_WORD_TRANSLATION(list_name, en, ...)       static const char * const __pstr__L_##list_name[] = {en, nullptr};
@@ -111,6 +111,11 @@ static void setup_commands(std::shared_ptr<Commands> & commands) {
                           string_vector{F_(show), F_(mqtt)},
                           [](Shell & shell, const std::vector<std::string> & arguments) { Mqtt::show_mqtt(shell); });
 
+    commands->add_command(ShellContext::MAIN,
+                          CommandFlags::USER,
+                          string_vector{F_(show), F_(profile)},
+                          [](Shell & shell, const std::vector<std::string> & arguments) { to_app(shell).profiler_.show(shell); });
+
 
     commands->add_command(ShellContext::MAIN,
                           CommandFlags::USER,
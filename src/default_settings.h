@@ -57,6 +57,10 @@
 #define EMSESP_DEFAULT_SYSLOG_PORT 514
 #endif
 
+#ifndef EMSESP_DEFAULT_SYSLOG_TCP
+#define EMSESP_DEFAULT_SYSLOG_TCP false
+#endif
+
 #ifndef EMSESP_DEFAULT_TRACELOG_RAW
 #define EMSESP_DEFAULT_TRACELOG_RAW false
 #endif
@@ -85,6 +89,10 @@
 #define EMSESP_DEFAULT_DALLAS_PARASITE false
 #endif
 
+#ifndef EMSESP_DEFAULT_DALLAS_BUDGET
+#define EMSESP_DEFAULT_DALLAS_BUDGET 2
+#endif
+
 #ifndef EMSESP_DEFAULT_NOTOKEN_API
 #define EMSESP_DEFAULT_NOTOKEN_API false
 #endif
@@ -181,6 +189,10 @@
 #define EMSESP_DEFAULT_PUBLISH_SINGLE2CMD false
 #endif
 
+#ifndef EMSESP_DEFAULT_PUBLISH_DELTA
+#define EMSESP_DEFAULT_PUBLISH_DELTA false
+#endif
+
 #ifndef EMSESP_DEFAULT_SEND_RESPONSE
 #define EMSESP_DEFAULT_SEND_RESPONSE false
 #endif
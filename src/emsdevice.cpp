@@ -298,16 +298,32 @@ const std::string EMSdevice::to_string_short() {
 }
 
 // for each telegram that has the fetch value set (true) do a read request
-void EMSdevice::fetch_values() {
+// a scheduled fetch skips the telegrams that were broadcasted recently or have not changed for a while
+// returns the number of skipped read requests
+uint8_t EMSdevice::fetch_values(const bool scheduled) {
 #if defined(EMSESP_DEBUG)
     EMSESP::logger().debug("Fetching values for deviceID 0x%02X", device_id());
 #endif
 
-    for (const auto & tf : telegram_functions_) {
-        if (tf.fetch_) {
-            read_command(tf.telegram_type_id_);
+    uint32_t now     = uuid::get_uptime();
+    uint8_t  skipped = 0;
+    for (auto & tf : telegram_functions_) {
+        if (!tf.fetch_) {
+            continue;
+        }
+        if (scheduled) {
+            // broadcasted more often than we fetch and the next one is not overdue
+            bool broadcasted = tf.broadcast_period_ && tf.broadcast_period_ < EMSESP::EMS_FETCH_FREQUENCY
+                               && (now - tf.last_broadcast_) < tf.broadcast_period_ + tf.broadcast_period_ / 2;
+            if (broadcasted || ++tf.fetch_skipped_ < tf.fetch_backoff_) {
+                skipped++;
+                continue;
+            }
         }
+        tf.fetch_skipped_ = 0;
+        read_command(tf.telegram_type_id_);
     }
+    return skipped;
 }
 
 // toggle on/off automatic fetch for a telegramID
@@ -325,12 +341,8 @@ void EMSdevice::toggle_fetch(uint16_t telegram_id, bool toggle) {
 
 // get status of automatic fetch for a telegramID
 bool EMSdevice::is_fetch(uint16_t telegram_id) const {
-    for (const auto & tf : telegram_functions_) {
-        if (tf.telegram_type_id_ == telegram_id) {
-            return tf.fetch_;
-        }
-    }
-    return false;
+    auto i = telegram_function_index(telegram_id);
+    return (i >= 0) && telegram_functions_[i].fetch_;
 }
 
 // check for a tag to create a nest
@@ -473,10 +485,26 @@ void EMSdevice::show_mqtt_handlers(uuid::console::Shell & shell) const {
 }
 
 // register a callback function for a specific telegram type
+// also adds it to the sorted index, after any existing entry with the same type_id so the first registration wins
 void EMSdevice::register_telegram_type(const uint16_t telegram_type_id, const char * telegram_type_name, bool fetch, const process_function_p f) {
+    auto it = std::upper_bound(telegram_index_.begin(), telegram_index_.end(), telegram_type_id, [](const uint16_t id, const TelegramIndex & ti) {
+        return id < ti.telegram_type_id_;
+    });
+    telegram_index_.insert(it, {telegram_type_id, (uint8_t)telegram_functions_.size()});
     telegram_functions_.emplace_back(telegram_type_id, telegram_type_name, fetch, false, f);
 }
 
+// binary search the index for a type_id, returns the position in telegram_functions_ or -1 if not registered
+int16_t EMSdevice::telegram_function_index(const uint16_t telegram_type_id) const {
+    auto it = std::lower_bound(telegram_index_.begin(), telegram_index_.end(), telegram_type_id, [](const TelegramIndex & ti, const uint16_t id) {
+        return ti.telegram_type_id_ < id;
+    });
+    if (it == telegram_index_.end() || it->telegram_type_id_ != telegram_type_id) {
+        return -1;
+    }
+    return it->index_;
+}
+
 // add to device value library, also know now as a "device entity"
 void EMSdevice::add_device_value(uint8_t               tag,              // to be used to group mqtt together, either as separate topics as a nested object
                                  void *                value_p,          // pointer to the value from the .h file
@@ -526,25 +554,27 @@ void EMSdevice::add_device_value(uint8_t               tag,              // to b
     }
 
     // scan through customizations to see if it's on the exclusion list by matching the productID and deviceID
+    // this runs for every entity when the device is created, so compare in place without copying the lists
     EMSESP::webCustomizationService.read([&](WebCustomization & settings) {
-        for (EntityCustomization entityCustomization : settings.entityCustomizations) {
+        for (const EntityCustomization & entityCustomization : settings.entityCustomizations) {
             if ((entityCustomization.product_id == product_id()) && (entityCustomization.device_id == device_id())) {
                 char entity[70];
                 if (tag < DeviceValueTAG::TAG_HC1) {
-                    strncpy(entity, short_name, sizeof(entity));
+                    strlcpy(entity, short_name, sizeof(entity));
                 } else {
                     snprintf(entity, sizeof(entity), "%s/%s", tag_to_mqtt(tag), short_name);
                 }
+                size_t entity_len = strlen(entity);
 
-                for (std::string entity_id : entityCustomization.entity_ids) {
+                for (const std::string & entity_id : entityCustomization.entity_ids) {
                     // if there is an appended custom name, strip it to get the true entity name
                     // and extract the new custom name
-                    auto        custom_name_pos = entity_id.find('|');
-                    bool        has_custom_name = (custom_name_pos != std::string::npos);
-                    std::string shortname       = has_custom_name ? entity_id.substr(2, custom_name_pos - 2) : entity_id.substr(2);
+                    auto   custom_name_pos = entity_id.find('|');
+                    bool   has_custom_name = (custom_name_pos != std::string::npos);
+                    size_t shortname_len   = has_custom_name ? custom_name_pos - 2 : entity_id.size() - 2;
 
                     // we found the device entity
-                    if (shortname == entity) {
+                    if (entity_id.size() > 2 && shortname_len == entity_len && entity_id.compare(2, shortname_len, entity) == 0) {
                         // get Mask
                         uint8_t mask = Helpers::hextoint(entity_id.substr(0, 2).c_str());
                         state        = mask << 4;             // set state high bits to flag, turn off active and ha flags
@@ -567,6 +597,13 @@ void EMSdevice::add_device_value(uint8_t               tag,              // to b
     devicevalues_.emplace_back(
         device_type_, tag, value_p, type, options, options_single, numeric_operator, short_name, fullname, custom_fullname, uom, has_cmd, min, max, state);
 
+    // keep the value pointer index sorted, entries sharing a pointer stay in registration order
+    ValueIndex entry{value_p, (uint16_t)(devicevalues_.size() - 1)};
+    auto       it = std::upper_bound(value_index_.begin(), value_index_.end(), entry, [](const ValueIndex & a, const ValueIndex & b) {
+        return std::less<const void *>()(a.value_p_, b.value_p_);
+    });
+    value_index_.insert(it, entry);
+
     // add a new command if it has a function attached
     if (has_cmd) {
         uint8_t flags = CommandFlag::ADMIN_ONLY; // executing commands require admin privileges
@@ -680,12 +717,22 @@ void EMSdevice::register_device_value(uint8_t tag, void * value_p, uint8_t type,
     add_device_value(tag, value_p, type, options, nullptr, 0, name, uom, nullptr, 0, 0);
 }
 
+// returns the first value pointer index entry for value_p, or end() if not registered
+std::vector<EMSdevice::ValueIndex>::const_iterator EMSdevice::value_index_first(const void * value_p) const {
+    auto it = std::lower_bound(value_index_.begin(), value_index_.end(), value_p, [](const ValueIndex & a, const void * p) {
+        return std::less<const void *>()(a.value_p_, p);
+    });
+    if (it != value_index_.end() && it->value_p_ != value_p) {
+        return value_index_.end();
+    }
+    return it;
+}
+
 // check if value is readable via mqtt/api
 bool EMSdevice::is_readable(const void * value_p) const {
-    for (const auto & dv : devicevalues_) {
-        if (dv.value_p == value_p) {
-            return !dv.has_state(DeviceValueState::DV_API_MQTT_EXCLUDE);
-        }
+    auto it = value_index_first(value_p);
+    if (it != value_index_.end()) {
+        return !devicevalues_[it->index_].has_state(DeviceValueState::DV_API_MQTT_EXCLUDE);
     }
     return false;
 }
@@ -705,46 +752,66 @@ bool EMSdevice::is_readonly(const std::string & cmd, const int8_t id) const {
 
 // check if value has a registered command
 bool EMSdevice::has_command(const void * value_p) const {
-    for (const auto & dv : devicevalues_) {
-        if (dv.value_p == value_p) {
-            return dv.has_cmd && !dv.has_state(DeviceValueState::DV_READONLY);
-        }
+    auto it = value_index_first(value_p);
+    if (it != value_index_.end()) {
+        const auto & dv = devicevalues_[it->index_];
+        return dv.has_cmd && !dv.has_state(DeviceValueState::DV_READONLY);
     }
     return false;
 }
 
 // set min and max
 void EMSdevice::set_minmax(const void * value_p, int16_t min, uint32_t max) {
-    for (auto & dv : devicevalues_) {
-        if (dv.value_p == value_p) {
-            dv.min = min;
-            dv.max = max;
-            return;
+    auto it = value_index_first(value_p);
+    if (it != value_index_.end()) {
+        devicevalues_[it->index_].min = min;
+        devicevalues_[it->index_].max = max;
+    }
+}
+
+// returns the single value topic of a device value
+// the topic is cached and only rebuilt when the MQTT settings it depends on have changed
+const char * EMSdevice::value_topic(DeviceValue & dv) {
+    if (dv.mqtt_topic_fmt == Mqtt::topic_format()) {
+        return dv.mqtt_topic.c_str();
+    }
+
+    char topic[Mqtt::MQTT_TOPIC_MAX_SIZE];
+    if (Mqtt::publish_single2cmd()) {
+        if (dv.tag >= DeviceValueTAG::TAG_HC1) {
+            snprintf(topic, sizeof(topic), "%s/%s/%s", device_type_2_device_name(device_type_), tag_to_mqtt(dv.tag), dv.short_name);
+        } else {
+            snprintf(topic, sizeof(topic), "%s/%s", device_type_2_device_name(device_type_), (dv.short_name));
         }
+    } else if (Mqtt::is_nested() && dv.tag >= DeviceValueTAG::TAG_HC1) {
+        snprintf(topic, sizeof(topic), "%s/%s/%s", Mqtt::tag_to_topic(device_type_, dv.tag).c_str(), tag_to_mqtt(dv.tag), dv.short_name);
+    } else {
+        snprintf(topic, sizeof(topic), "%s/%s", Mqtt::tag_to_topic(device_type_, dv.tag).c_str(), dv.short_name);
+    }
+
+    dv.mqtt_topic     = topic;
+    dv.mqtt_topic_fmt = Mqtt::topic_format();
+    return dv.mqtt_topic.c_str();
+}
+
+// flag a value as changed for the next MQTT publish and publish it if single values are enabled
+void EMSdevice::value_changed(void * value_p) {
+    has_update_ = true;
+    for (auto it = value_index_first(value_p); it != value_index_.end() && it->value_p_ == value_p; ++it) {
+        devicevalues_[it->index_].add_state(DeviceValueState::DV_CHANGED);
     }
+    publish_value(value_p);
 }
 
 // publish a single value on change
-void EMSdevice::publish_value(void * value_p) const {
+void EMSdevice::publish_value(void * value_p) {
     if (!Mqtt::publish_single() || value_p == nullptr) {
         return;
     }
 
-    for (const auto & dv : devicevalues_) {
-        if (dv.value_p == value_p && !dv.has_state(DeviceValueState::DV_API_MQTT_EXCLUDE)) {
-            char topic[Mqtt::MQTT_TOPIC_MAX_SIZE];
-            if (Mqtt::publish_single2cmd()) {
-                if (dv.tag >= DeviceValueTAG::TAG_HC1) {
-                    snprintf(topic, sizeof(topic), "%s/%s/%s", device_type_2_device_name(device_type_), tag_to_mqtt(dv.tag), dv.short_name);
-                } else {
-                    snprintf(topic, sizeof(topic), "%s/%s", device_type_2_device_name(device_type_), (dv.short_name));
-                }
-            } else if (Mqtt::is_nested() && dv.tag >= DeviceValueTAG::TAG_HC1) {
-                snprintf(topic, sizeof(topic), "%s/%s/%s", Mqtt::tag_to_topic(device_type_, dv.tag).c_str(), tag_to_mqtt(dv.tag), dv.short_name);
-            } else {
-                snprintf(topic, sizeof(topic), "%s/%s", Mqtt::tag_to_topic(device_type_, dv.tag).c_str(), dv.short_name);
-            }
-
+    for (auto it = value_index_first(value_p); it != value_index_.end() && it->value_p_ == value_p; ++it) {
+        auto & dv = devicevalues_[it->index_];
+        if (!dv.has_state(DeviceValueState::DV_API_MQTT_EXCLUDE)) {
             int8_t num_op = dv.numeric_operator;
 
             char    payload[55] = {'\0'};
@@ -796,7 +863,7 @@ void EMSdevice::publish_value(void * value_p) const {
             }
 
             if (payload[0] != '\0') {
-                Mqtt::queue_publish(topic, payload);
+                Mqtt::queue_publish(value_topic(dv), payload);
             }
         }
     }
@@ -1116,9 +1183,9 @@ void EMSdevice::setCustomizationEntity(const std::string & entity_id) {
 
             // set the custom name if it has one, or clear it
             if (has_custom_name) {
-                dv.custom_fullname = entity_id.substr(custom_name_pos + 1);
+                dv.set_custom_fullname(entity_id.substr(custom_name_pos + 1));
             } else {
-                dv.custom_fullname = "";
+                dv.set_custom_fullname("");
             }
 
             auto min = dv.min;
@@ -1136,6 +1203,15 @@ void EMSdevice::setCustomizationEntity(const std::string & entity_id) {
     }
 }
 
+// release the spare capacity left in the lists after the constructor registered all entities and telegrams
+// values added later, like a new heating circuit, will grow them again
+void EMSdevice::shrink_to_fit() {
+    devicevalues_.shrink_to_fit();
+    value_index_.shrink_to_fit();
+    telegram_functions_.shrink_to_fit();
+    telegram_index_.shrink_to_fit();
+}
+
 // populate a string vector with entities that have masks set or have a custom name
 void EMSdevice::getCustomizationEntities(std::vector<std::string> & entity_ids) {
     for (const auto & dv : devicevalues_) {
@@ -1157,11 +1233,11 @@ void EMSdevice::getCustomizationEntities(std::vector<std::string> & entity_ids)
                 break;
             }
         }
-        if (!is_set && (mask || !dv.custom_fullname.empty())) {
-            if (dv.custom_fullname.empty()) {
+        if (!is_set && (mask || dv.custom_fullname)) {
+            if (!dv.custom_fullname) {
                 entity_ids.push_back(Helpers::hextoa(mask, false) + entity_name);
             } else {
-                entity_ids.push_back(Helpers::hextoa(mask, false) + entity_name + "|" + dv.custom_fullname);
+                entity_ids.push_back(Helpers::hextoa(mask, false) + entity_name + "|" + *dv.custom_fullname);
             }
         }
     }
@@ -1544,7 +1620,8 @@ void EMSdevice::publish_all_values() {
 // For each value in the device create the json object pair and add it to given json
 // return false if empty
 // this is used to create the MQTT payloads, Console messages and Web API calls
-bool EMSdevice::generate_values(JsonObject & output, const uint8_t tag_filter, const bool nested, const uint8_t output_target) {
+// changed_only is used for MQTT delta publishing and skips all values not changed since the last publish
+bool EMSdevice::generate_values(JsonObject & output, const uint8_t tag_filter, const bool nested, const uint8_t output_target, const bool changed_only) {
     bool       has_values = false; // to see if we've added a value. it's faster than doing a json.size() at the end
     uint8_t    old_tag    = 255;   // NAN
     JsonObject json       = output;
@@ -1554,144 +1631,179 @@ bool EMSdevice::generate_values(JsonObject & output, const uint8_t tag_filter, c
         // not that this will override any previously removed states
         (dv.hasValue()) ? dv.add_state(DeviceValueState::DV_ACTIVE) : dv.remove_state(DeviceValueState::DV_ACTIVE);
 
-        auto fullname = dv.get_fullname();
+        // a MQTT publish includes all changes for this tag
+        bool changed = dv.has_state(DeviceValueState::DV_CHANGED);
+        if (output_target == OUTPUT_TARGET::MQTT && (tag_filter == DeviceValueTAG::TAG_NONE || tag_filter == dv.tag)) {
+            dv.remove_state(DeviceValueState::DV_CHANGED);
+        }
+        if (changed_only && !changed) {
+            continue;
+        }
 
-        // check conditions:
-        //  1. it must have a valid value (state is active)
-        //  2. it must have a visible flag
-        //  3. it must match the given tag filter or have an empty tag
-        //  4. it must not have the exclude flag set or outputs to console
-        if (dv.has_state(DeviceValueState::DV_ACTIVE) && !fullname.empty() && (tag_filter == DeviceValueTAG::TAG_NONE || tag_filter == dv.tag)
-            && (output_target == OUTPUT_TARGET::CONSOLE || !dv.has_state(DeviceValueState::DV_API_MQTT_EXCLUDE))) {
-            has_values = true; // flagged if we actually have data
+        if (!is_output_value(dv, tag_filter, output_target)) {
+            continue;
+        }
+        has_values = true; // flagged if we actually have data
 
-            // we have a tag if it matches the filter given, and that the tag name is not empty/""
-            bool have_tag = ((dv.tag != tag_filter) && dv.has_tag());
+        // if we have a tag, and its different to the last one create a nested object. only for hc, wwc and hs
+        if (output_target != OUTPUT_TARGET::API_VERBOSE && output_target != OUTPUT_TARGET::CONSOLE && dv.tag != old_tag) {
+            old_tag = dv.tag;
+            if (nested && (dv.tag != tag_filter) && dv.has_tag() && dv.tag >= DeviceValueTAG::TAG_HC1) {
+                json = output.createNestedObject(tag_to_mqtt(dv.tag));
+            }
+        }
 
-            // create the name for the JSON key
-            char name[80];
+        render_value(json, dv, tag_filter, output_target);
+    }
 
-            if (output_target == OUTPUT_TARGET::API_VERBOSE || output_target == OUTPUT_TARGET::CONSOLE) {
-                char short_name[20];
-                if (output_target == OUTPUT_TARGET::CONSOLE) {
-                    snprintf(short_name, sizeof(short_name), " (%s)", dv.short_name);
-                } else {
-                    strcpy(short_name, "");
-                }
-                if (have_tag) {
-                    snprintf(name, sizeof(name), "%s %s%s", tag_to_string(dv.tag), fullname.c_str(), short_name); // prefix the tag
-                } else {
-                    snprintf(name, sizeof(name), "%s%s", fullname.c_str(), short_name);
-                }
-            } else {
-                strlcpy(name, (dv.short_name), sizeof(name)); // use short name
+    return has_values;
+}
 
-                // if we have a tag, and its different to the last one create a nested object. only for hc, wwc and hs
-                if (dv.tag != old_tag) {
-                    old_tag = dv.tag;
-                    if (nested && have_tag && dv.tag >= DeviceValueTAG::TAG_HC1) {
-                        json = output.createNestedObject(tag_to_mqtt(dv.tag));
-                    }
-                }
-            }
+// adds a single value as json object pair, used to stream large API responses one entity at the time
+// the index is the position of the entity in the device, values are added to the output without nesting
+// return false if the entity is not shown
+bool EMSdevice::generate_value(JsonObject & output, const size_t index, const uint8_t tag_filter, const uint8_t output_target) {
+    if (index >= devicevalues_.size()) {
+        return false;
+    }
 
-            // handle Booleans
-            if (dv.type == DeviceValueType::BOOL && Helpers::hasValue(*(uint8_t *)(dv.value_p), EMS_VALUE_BOOL)) {
-                // see how to render the value depending on the setting
-                auto value_b = (bool)*(uint8_t *)(dv.value_p);
-                if (output_target == OUTPUT_TARGET::CONSOLE) {
-                    char s[12];
-                    json[name] = Helpers::render_boolean(s, value_b, true); // console use web settings
-                } else if (EMSESP::system_.bool_format() == BOOL_FORMAT_TRUEFALSE) {
-                    json[name] = value_b;
-                } else if (EMSESP::system_.bool_format() == BOOL_FORMAT_10) {
-                    json[name] = value_b ? 1 : 0;
-                } else {
-                    char s[12];
-                    json[name] = Helpers::render_boolean(s, value_b);
-                }
-            }
+    auto & dv = devicevalues_[index];
+    (dv.hasValue()) ? dv.add_state(DeviceValueState::DV_ACTIVE) : dv.remove_state(DeviceValueState::DV_ACTIVE);
+    if (!is_output_value(dv, tag_filter, output_target)) {
+        return false;
+    }
 
-            // handle TEXT strings
-            else if (dv.type == DeviceValueType::STRING) {
-                json[name] = (char *)(dv.value_p);
-            }
+    render_value(output, dv, tag_filter, output_target);
+    return true;
+}
 
-            // handle ENUMs
-            else if ((dv.type == DeviceValueType::ENUM) && (*(uint8_t *)(dv.value_p) < dv.options_size)) {
-                // check for numeric enum-format, console use text format
-                if (EMSESP::system_.enum_format() == ENUM_FORMAT_INDEX && output_target != OUTPUT_TARGET::CONSOLE) {
-                    json[name] = (uint8_t)(*(uint8_t *)(dv.value_p));
-                } else {
-                    json[name] = Helpers::translated_word(dv.options[*(uint8_t *)(dv.value_p)]);
-                }
-            }
+// check conditions:
+//  1. it must have a valid value (state is active)
+//  2. it must have a visible flag
+//  3. it must match the given tag filter or have an empty tag
+//  4. it must not have the exclude flag set or outputs to console
+bool EMSdevice::is_output_value(const DeviceValue & dv, const uint8_t tag_filter, const uint8_t output_target) const {
+    return dv.has_state(DeviceValueState::DV_ACTIVE) && !dv.get_fullname().empty() && (tag_filter == DeviceValueTAG::TAG_NONE || tag_filter == dv.tag)
+           && (output_target == OUTPUT_TARGET::CONSOLE || !dv.has_state(DeviceValueState::DV_API_MQTT_EXCLUDE));
+}
 
-            // handle Numbers
-            else {
-                // fahrenheit, 0 is no conversion other 1 or 2. not sure why?
-                uint8_t fahrenheit = !EMSESP::system_.fahrenheit()           ? 0
-                                     : (dv.uom == DeviceValueUOM::DEGREES)   ? 2
-                                     : (dv.uom == DeviceValueUOM::DEGREES_R) ? 1
-                                                                             : 0;
-                char    val[10]    = {'\0'};
-                if (dv.type == DeviceValueType::INT) {
-                    json[name] = serialized(Helpers::render_value(val, *(int8_t *)(dv.value_p), dv.numeric_operator, fahrenheit));
-                } else if (dv.type == DeviceValueType::UINT) {
-                    json[name] = serialized(Helpers::render_value(val, *(uint8_t *)(dv.value_p), dv.numeric_operator, fahrenheit));
-                } else if (dv.type == DeviceValueType::SHORT) {
-                    json[name] = serialized(Helpers::render_value(val, *(int16_t *)(dv.value_p), dv.numeric_operator, fahrenheit));
-                } else if (dv.type == DeviceValueType::USHORT) {
-                    json[name] = serialized(Helpers::render_value(val, *(uint16_t *)(dv.value_p), dv.numeric_operator, fahrenheit));
-                } else if (dv.type == DeviceValueType::ULONG) {
-                    json[name] = serialized(Helpers::render_value(val, *(uint32_t *)(dv.value_p), dv.numeric_operator));
-                } else if ((dv.type == DeviceValueType::TIME) && Helpers::hasValue(*(uint32_t *)(dv.value_p))) {
-                    uint32_t time_value = *(uint32_t *)(dv.value_p);
-                    if (dv.numeric_operator == DeviceValueNumOp::DV_NUMOP_DIV60) {
-                        time_value /= 60; // sometimes we need to divide by 60
-                    }
-                    if (output_target == OUTPUT_TARGET::API_VERBOSE || output_target == OUTPUT_TARGET::CONSOLE) {
-                        char time_s[60];
-                        snprintf(time_s,
-                                 sizeof(time_s),
-                                 "%d %s %d %s %d %s",
-                                 (time_value / 1440),
-                                 Helpers::translated_word(FL_(days)),
-                                 ((time_value % 1440) / 60),
-                                 Helpers::translated_word(FL_(hours)),
-                                 (time_value % 60),
-                                 Helpers::translated_word(FL_(minutes)));
-                        json[name] = time_s;
-                    } else {
-                        json[name] = serialized(Helpers::render_value(val, time_value, 0));
-                    }
-                }
+// add the value with its name for the output target to the json
+void EMSdevice::render_value(JsonObject & json, DeviceValue & dv, const uint8_t tag_filter, const uint8_t output_target) {
+    // we have a tag if it matches the filter given, and that the tag name is not empty/""
+    bool have_tag = ((dv.tag != tag_filter) && dv.has_tag());
 
-                // commenting out - we don't want Commands in MQTT or Console
-                //  else if (dv.type == DeviceValueType::CMD && output_target != EMSdevice::OUTPUT_TARGET::MQTT) {
-                //     json[name] = "";
-                // }
-
-                // check for value outside min/max range and adapt the limits to avoid HA complains
-                // Should this also check for api output?
-                if ((output_target == OUTPUT_TARGET::MQTT) && (dv.min != 0 || dv.max != 0)) {
-                    int v = Helpers::atoint(val);
-                    if (fahrenheit) {
-                        v = (v - (32 * (fahrenheit - 1))) / 1.8; // reset to °C
-                    }
-                    if (v < dv.min) {
-                        dv.min = v;
-                        dv.remove_state(DeviceValueState::DV_HA_CONFIG_CREATED);
-                    } else if (v > 0 && (uint32_t)v > dv.max) {
-                        dv.max = v;
-                        dv.remove_state(DeviceValueState::DV_HA_CONFIG_CREATED);
-                    }
-                }
-            }
+    // create the name for the JSON key
+    char name[80];
+
+    if (output_target == OUTPUT_TARGET::API_VERBOSE || output_target == OUTPUT_TARGET::CONSOLE) {
+        char short_name[20];
+        if (output_target == OUTPUT_TARGET::CONSOLE) {
+            snprintf(short_name, sizeof(short_name), " (%s)", dv.short_name);
+        } else {
+            strcpy(short_name, "");
+        }
+        if (have_tag) {
+            snprintf(name, sizeof(name), "%s %s%s", tag_to_string(dv.tag), dv.get_fullname().c_str(), short_name); // prefix the tag
+        } else {
+            snprintf(name, sizeof(name), "%s%s", dv.get_fullname().c_str(), short_name);
+        }
+    } else {
+        strlcpy(name, (dv.short_name), sizeof(name)); // use short name
+    }
+
+    // handle Booleans
+    if (dv.type == DeviceValueType::BOOL && Helpers::hasValue(*(uint8_t *)(dv.value_p), EMS_VALUE_BOOL)) {
+        // see how to render the value depending on the setting
+        auto value_b = (bool)*(uint8_t *)(dv.value_p);
+        if (output_target == OUTPUT_TARGET::CONSOLE) {
+            char s[12];
+            json[name] = Helpers::render_boolean(s, value_b, true); // console use web settings
+        } else if (EMSESP::system_.bool_format() == BOOL_FORMAT_TRUEFALSE) {
+            json[name] = value_b;
+        } else if (EMSESP::system_.bool_format() == BOOL_FORMAT_10) {
+            json[name] = value_b ? 1 : 0;
+        } else {
+            char s[12];
+            json[name] = Helpers::render_boolean(s, value_b);
         }
     }
 
-    return has_values;
+    // handle TEXT strings
+    else if (dv.type == DeviceValueType::STRING) {
+        json[name] = (char *)(dv.value_p);
+    }
+
+    // handle ENUMs
+    else if ((dv.type == DeviceValueType::ENUM) && (*(uint8_t *)(dv.value_p) < dv.options_size)) {
+        // check for numeric enum-format, console use text format
+        if (EMSESP::system_.enum_format() == ENUM_FORMAT_INDEX && output_target != OUTPUT_TARGET::CONSOLE) {
+            json[name] = (uint8_t)(*(uint8_t *)(dv.value_p));
+        } else {
+            json[name] = Helpers::translated_word(dv.options[*(uint8_t *)(dv.value_p)]);
+        }
+    }
+
+    // handle Numbers
+    else {
+        // fahrenheit, 0 is no conversion other 1 or 2. not sure why?
+        uint8_t fahrenheit = !EMSESP::system_.fahrenheit()           ? 0
+                             : (dv.uom == DeviceValueUOM::DEGREES)   ? 2
+                             : (dv.uom == DeviceValueUOM::DEGREES_R) ? 1
+                                                                     : 0;
+        char    val[10]    = {'\0'};
+        if (dv.type == DeviceValueType::INT) {
+            json[name] = serialized(Helpers::render_value(val, *(int8_t *)(dv.value_p), dv.numeric_operator, fahrenheit));
+        } else if (dv.type == DeviceValueType::UINT) {
+            json[name] = serialized(Helpers::render_value(val, *(uint8_t *)(dv.value_p), dv.numeric_operator, fahrenheit));
+        } else if (dv.type == DeviceValueType::SHORT) {
+            json[name] = serialized(Helpers::render_value(val, *(int16_t *)(dv.value_p), dv.numeric_operator, fahrenheit));
+        } else if (dv.type == DeviceValueType::USHORT) {
+            json[name] = serialized(Helpers::render_value(val, *(uint16_t *)(dv.value_p), dv.numeric_operator, fahrenheit));
+        } else if (dv.type == DeviceValueType::ULONG) {
+            json[name] = serialized(Helpers::render_value(val, *(uint32_t *)(dv.value_p), dv.numeric_operator));
+        } else if ((dv.type == DeviceValueType::TIME) && Helpers::hasValue(*(uint32_t *)(dv.value_p))) {
+            uint32_t time_value = *(uint32_t *)(dv.value_p);
+            if (dv.numeric_operator == DeviceValueNumOp::DV_NUMOP_DIV60) {
+                time_value /= 60; // sometimes we need to divide by 60
+            }
+            if (output_target == OUTPUT_TARGET::API_VERBOSE || output_target == OUTPUT_TARGET::CONSOLE) {
+                char time_s[60];
+                snprintf(time_s,
+                         sizeof(time_s),
+                         "%d %s %d %s %d %s",
+                         (time_value / 1440),
+                         Helpers::translated_word(FL_(days)),
+                         ((time_value % 1440) / 60),
+                         Helpers::translated_word(FL_(hours)),
+                         (time_value % 60),
+                         Helpers::translated_word(FL_(minutes)));
+                json[name] = time_s;
+            } else {
+                json[name] = serialized(Helpers::render_value(val, time_value, 0));
+            }
+        }
+
+        // commenting out - we don't want Commands in MQTT or Console
+        //  else if (dv.type == DeviceValueType::CMD && output_target != EMSdevice::OUTPUT_TARGET::MQTT) {
+        //     json[name] = "";
+        // }
+
+        // check for value outside min/max range and adapt the limits to avoid HA complains
+        // Should this also check for api output?
+        if ((output_target == OUTPUT_TARGET::MQTT) && (dv.min != 0 || dv.max != 0)) {
+            int v = Helpers::atoint(val);
+            if (fahrenheit) {
+                v = (v - (32 * (fahrenheit - 1))) / 1.8; // reset to °C
+            }
+            if (v < dv.min) {
+                dv.min = v;
+                dv.remove_state(DeviceValueState::DV_HA_CONFIG_CREATED);
+            } else if (v > 0 && (uint32_t)v > dv.max) {
+                dv.max = v;
+                dv.remove_state(DeviceValueState::DV_HA_CONFIG_CREATED);
+            }
+        }
+    }
 }
 
 // create the Home Assistant configs for each device value / entity
@@ -1725,34 +1837,46 @@ void EMSdevice::mqtt_ha_entity_config_create() {
                 dv.add_state(DeviceValueState::DV_HA_CONFIG_CREATED);
                 create_device_config = false; // only create the main config once
             }
-#ifndef EMSESP_STANDALONE
-            // always create minimum one config
-            if (ESP.getMaxAllocHeap() < (6 * 1024) || (!emsesp::EMSESP::system_.PSram() && ESP.getFreeHeap() < (65 * 1024))) {
+            // always create minimum one config, unchanged configs are skipped and don't take queue space
+            if (!Mqtt::ha_can_queue()) {
                 break;
             }
-#endif
         }
     }
 
     ha_config_done(!create_device_config);
 }
 
-// remove all config topics in HA
-void EMSdevice::ha_config_clear() {
+// recreate all config topics in HA, only the changed ones are published again unless forced
+void EMSdevice::ha_config_clear(const bool force) {
     for (auto & dv : devicevalues_) {
         dv.remove_state(DeviceValueState::DV_HA_CONFIG_CREATED);
+        if (force) {
+            dv.ha_config_hash = 0;
+        }
     }
 
     ha_config_done(false); // this will force the recreation of the main HA device config
 }
 
-bool EMSdevice::has_telegram_id(uint16_t id) const {
-    for (const auto & tf : telegram_functions_) {
-        if (tf.telegram_type_id_ == id) {
-            return true;
+// clear the config hash and state of published configs the broker did not send back as retained
+uint16_t EMSdevice::ha_config_verify(const std::vector<uint32_t> & retained) {
+    uint16_t missing = 0;
+    for (auto & dv : devicevalues_) {
+        if (dv.ha_config_hash && !std::binary_search(retained.begin(), retained.end(), dv.ha_config_hash)) {
+            dv.ha_config_hash = 0;
+            dv.remove_state(DeviceValueState::DV_HA_CONFIG_CREATED);
+            missing++;
         }
     }
-    return false;
+    if (missing) {
+        ha_config_done(false); // the main HA device config is part of one of the entity configs
+    }
+    return missing;
+}
+
+bool EMSdevice::has_telegram_id(uint16_t id) const {
+    return telegram_function_index(id) >= 0;
 }
 
 // return the name of the telegram type
@@ -1764,10 +1888,9 @@ const char * EMSdevice::telegram_type_name(std::shared_ptr<const Telegram> teleg
         return "UBADevices";
     }
 
-    for (const auto & tf : telegram_functions_) {
-        if ((tf.telegram_type_id_ == telegram->type_id) && (telegram->type_id != 0xFF)) {
-            return tf.telegram_type_name_;
-        }
+    auto i = telegram_function_index(telegram->type_id);
+    if ((i >= 0) && (telegram->type_id != 0xFF)) {
+        return telegram_functions_[i].telegram_type_name_;
     }
 
     return "";
@@ -1776,31 +1899,68 @@ const char * EMSdevice::telegram_type_name(std::shared_ptr<const Telegram> teleg
 // take a telegram_type_id and call the matching handler
 // return true if match found
 bool EMSdevice::handle_telegram(std::shared_ptr<const Telegram> telegram) {
-    for (auto & tf : telegram_functions_) {
-        if (tf.telegram_type_id_ == telegram->type_id) {
-            // for telegram desitnation only read telegram
-            if (telegram->dest == device_id_ && telegram->message_length > 0) {
-                tf.process_function_(telegram);
-                return true;
-            }
-            // if the data block is empty and we have not received data before, assume that this telegram
-            // is not recognized by the bus master. So remove it from the automatic fetch list
-            if (telegram->message_length == 0 && telegram->offset == 0 && !tf.received_) {
+    auto i = telegram_function_index(telegram->type_id);
+    if (i < 0) {
+        return false; // type not found
+    }
+
+    auto & tf = telegram_functions_[i];
+
+    // for telegram desitnation only read telegram
+    if (telegram->dest == device_id_ && telegram->message_length > 0) {
+        uint32_t start = micros();
+        tf.process_function_(telegram);
+        EMSESP::profiler_.add_device(device_id_, start);
+        return true;
+    }
+    // if the data block is empty and we have not received data before, assume that this telegram
+    // is not recognized by the bus master. So remove it from the automatic fetch list
+    if (telegram->message_length == 0 && telegram->offset == 0 && !tf.received_) {
 #if defined(EMSESP_DEBUG)
-                EMSESP::logger().debug("This telegram (%s) is not recognized by the EMS bus", tf.telegram_type_name_);
+        EMSESP::logger().debug("This telegram (%s) is not recognized by the EMS bus", tf.telegram_type_name_);
 #endif
-                tf.fetch_ = false;
-                return false;
-            }
-            if (telegram->message_length > 0) {
-                tf.received_ = true;
-                tf.process_function_(telegram);
-            }
+        tf.fetch_ = false;
+        return false;
+    }
+    if (telegram->message_length > 0) {
+        update_fetch_interval(tf, telegram);
+        tf.received_ = true;
+        uint32_t start = micros();
+        tf.process_function_(telegram);
+        EMSESP::profiler_.add_device(device_id_, start);
+    }
 
-            return true;
+    return true;
+}
+
+// keep track of how often a telegram is broadcasted and if its data changes, see fetch_values()
+void EMSdevice::update_fetch_interval(TelegramFunction & tf, const std::shared_ptr<const Telegram> & telegram) {
+    if (telegram->offset) {
+        tf.multipart_     = true;
+        tf.fetch_backoff_ = 1;
+        return;
+    }
+
+    uint32_t now = uuid::get_uptime();
+    if ((telegram->dest & 0x7F) != EMSbus::ems_bus_id()) {
+        if (tf.last_broadcast_) {
+            uint32_t period      = now - tf.last_broadcast_;
+            tf.broadcast_period_ = tf.broadcast_period_ ? (tf.broadcast_period_ * 3 + period) / 4 : period;
         }
+        tf.last_broadcast_ = now;
+    }
+
+    // FNV-1a of the data block
+    uint32_t hash = 2166136261UL;
+    for (uint8_t i = 0; i < telegram->message_length; i++) {
+        hash = (hash ^ telegram->message_data[i]) * 16777619UL;
+    }
+    if (tf.received_ && !tf.multipart_ && hash == tf.data_hash_) {
+        tf.fetch_backoff_ = std::min((uint8_t)(tf.fetch_backoff_ * 2), FETCH_BACKOFF_MAX);
+    } else {
+        tf.fetch_backoff_ = 1;
     }
-    return false; // type not found
+    tf.data_hash_ = hash;
 }
 
 // send Tx write with a data block
@@ -135,62 +135,54 @@ class EMSdevice {
     }
 
     inline void has_update(void * value) {
-        has_update_ = true;
-        publish_value(value);
+        value_changed(value);
     }
 
     inline void has_update(char * value, const char * newvalue, size_t len) {
         if (strcmp(value, newvalue) != 0) {
             strlcpy(value, newvalue, len);
-            has_update_ = true;
-            publish_value(value);
+            value_changed(value);
         }
     }
 
     inline void has_update(uint8_t & value, uint8_t newvalue) {
         if (value != newvalue) {
-            value       = newvalue;
-            has_update_ = true;
-            publish_value((void *)&value);
+            value = newvalue;
+            value_changed((void *)&value);
         }
     }
 
     inline void has_update(uint16_t & value, uint16_t newvalue) {
         if (value != newvalue) {
-            value       = newvalue;
-            has_update_ = true;
-            publish_value((void *)&value);
+            value = newvalue;
+            value_changed((void *)&value);
         }
     }
 
     inline void has_update(uint32_t & value, uint32_t newvalue) {
         if (value != newvalue) {
-            value       = newvalue;
-            has_update_ = true;
-            publish_value((void *)&value);
+            value = newvalue;
+            value_changed((void *)&value);
         }
     }
 
     inline void has_enumupdate(std::shared_ptr<const Telegram> telegram, uint8_t & value, const uint8_t index, int8_t s = 0) {
         if (telegram->read_enumvalue(value, index, s)) {
-            has_update_ = true;
-            publish_value((void *)&value);
+            value_changed((void *)&value);
         }
     }
 
     template <typename Value>
     inline void has_update(std::shared_ptr<const Telegram> telegram, Value & value, const uint8_t index, uint8_t s = 0) {
         if (telegram->read_value(value, index, s)) {
-            has_update_ = true;
-            publish_value((void *)&value);
+            value_changed((void *)&value);
         }
     }
 
     template <typename BitValue>
     inline void has_bitupdate(std::shared_ptr<const Telegram> telegram, BitValue & value, const uint8_t index, uint8_t b) {
         if (telegram->read_bitvalue(value, index, b)) {
-            has_update_ = true;
-            publish_value((void *)&value);
+            value_changed((void *)&value);
         }
     }
 
@@ -212,13 +204,19 @@ class EMSdevice {
 
     void register_telegram_type(const uint16_t telegram_type_id, const char * telegram_type_name, bool fetch, const process_function_p cb);
     bool handle_telegram(std::shared_ptr<const Telegram> telegram);
+    void shrink_to_fit();
 
     std::string get_value_uom(const char * key) const;
     bool        get_value_info(JsonObject & root, const char * cmd, const int8_t id);
     void        get_dv_info(JsonObject & json);
 
     enum OUTPUT_TARGET : uint8_t { API_VERBOSE, API_SHORTNAMES, MQTT, CONSOLE };
-    bool generate_values(JsonObject & output, const uint8_t tag_filter, const bool nested, const uint8_t output_target);
+    bool generate_values(JsonObject & output, const uint8_t tag_filter, const bool nested, const uint8_t output_target, const bool changed_only = false);
+    bool generate_value(JsonObject & output, const size_t index, const uint8_t tag_filter, const uint8_t output_target);
+
+    size_t num_device_values() const {
+        return devicevalues_.size();
+    }
     void generate_values_web(JsonObject & output);
     void generate_values_web_customization(JsonArray & output);
 
@@ -304,18 +302,20 @@ class EMSdevice {
     bool is_readonly(const std::string & cmd, const int8_t id) const;
     bool has_command(const void * value_p) const;
     void set_minmax(const void * value_p, int16_t min, uint32_t max);
-    void publish_value(void * value_p) const;
+    void value_changed(void * value_p);
+    void publish_value(void * value_p);
     void publish_all_values();
 
     void mqtt_ha_entity_config_create();
 
     const char * telegram_type_name(std::shared_ptr<const Telegram> telegram);
 
-    void fetch_values();
+    uint8_t fetch_values(const bool scheduled = false);
     void toggle_fetch(uint16_t telegram_id, bool toggle);
     bool is_fetch(uint16_t telegram_id) const;
     bool has_telegram_id(uint16_t id) const;
-    void ha_config_clear();
+    void     ha_config_clear(const bool force = false);
+    uint16_t ha_config_verify(const std::vector<uint32_t> & retained);
 
     bool ha_config_done() const {
         return ha_config_done_;
@@ -458,12 +458,22 @@ class EMSdevice {
     bool ha_config_done_ = false;
     bool has_update_     = false;
 
+    // scheduled fetches are skipped for telegrams the device broadcasts regularly
+    // and fetched less often when the data did not change, up to every FETCH_BACKOFF_MAX fetch cycles
+    static constexpr uint8_t FETCH_BACKOFF_MAX = 8;
+
     struct TelegramFunction {
         const uint16_t           telegram_type_id_;   // it's type_id
         const char *             telegram_type_name_; // e.g. RC20Message
         bool                     fetch_;              // if this type_id be queried automatically
         bool                     received_;
         const process_function_p process_function_;
+        uint32_t                 last_broadcast_   = 0;     // uptime of the last telegram not sent to us
+        uint32_t                 broadcast_period_ = 0;     // average time between these telegrams
+        uint32_t                 data_hash_        = 0;     // of the data at offset 0, to see if it changed
+        uint8_t                  fetch_backoff_    = 1;     // fetch every n cycles
+        uint8_t                  fetch_skipped_    = 0;     // cycles skipped since the last fetch
+        bool                     multipart_        = false; // received with an offset, the data hash does not cover it
 
         TelegramFunction(uint16_t telegram_type_id, const char * telegram_type_name, bool fetch, bool received, const process_function_p process_function)
             : telegram_type_id_(telegram_type_id)
@@ -476,8 +486,31 @@ class EMSdevice {
 
     std::vector<TelegramFunction> telegram_functions_; // each EMS device has its own set of registered telegram types
 
+    // sorted lookup table of type_id to position in telegram_functions_, built in register_telegram_type()
+    struct TelegramIndex {
+        uint16_t telegram_type_id_;
+        uint8_t  index_;
+    };
+    std::vector<TelegramIndex> telegram_index_;
+
+    int16_t telegram_function_index(const uint16_t telegram_type_id) const;
+    void    update_fetch_interval(TelegramFunction & tf, const std::shared_ptr<const Telegram> & telegram);
+
     std::vector<DeviceValue> devicevalues_; // all the device values
 
+    // sorted lookup table of value pointer to position in devicevalues_, built in add_device_value()
+    struct ValueIndex {
+        const void * value_p_;
+        uint16_t     index_;
+    };
+    std::vector<ValueIndex> value_index_;
+
+    std::vector<ValueIndex>::const_iterator value_index_first(const void * value_p) const;
+    const char *                            value_topic(DeviceValue & dv);
+
+    bool is_output_value(const DeviceValue & dv, const uint8_t tag_filter, const uint8_t output_target) const;
+    void render_value(JsonObject & json, DeviceValue & dv, const uint8_t tag_filter, const uint8_t output_target);
+
     std::vector<uint16_t> handlers_ignored_;
 };
 
@@ -32,27 +32,28 @@ DeviceValue::DeviceValue(uint8_t               device_type,
                          int8_t                numeric_operator,
                          const char * const    short_name,
                          const char * const *  fullname,
-                         std::string &         custom_fullname,
+                         const std::string &   custom_fullname,
                          uint8_t               uom,
                          bool                  has_cmd,
                          int16_t               min,
                          uint32_t              max,
                          uint8_t               state)
-    : device_type(device_type)
-    , tag(tag)
-    , value_p(value_p)
-    , type(type)
+    : value_p(value_p)
     , options(options)
     , options_single(options_single)
-    , numeric_operator(numeric_operator)
     , short_name(short_name)
     , fullname(fullname)
-    , custom_fullname(custom_fullname)
+    , max(max)
+    , ha_config_hash(0)
+    , min(min)
+    , device_type(device_type)
+    , tag(tag)
+    , type(type)
+    , numeric_operator(numeric_operator)
     , uom(uom)
     , has_cmd(has_cmd)
-    , min(min)
-    , max(max)
-    , state(state) {
+    , state(state)
+    , mqtt_topic_fmt(0) {
     // calculate #options in options list
     if (options_single) {
         options_size = 1;
@@ -60,7 +61,8 @@ DeviceValue::DeviceValue(uint8_t               device_type,
         options_size = Helpers::count_items(options);
     }
 
-    // set the min/max
+    // set the custom name and min/max
+    set_custom_fullname(custom_fullname);
     set_custom_minmax();
 
     /*
@@ -70,9 +72,9 @@ DeviceValue::DeviceValue(uint8_t               device_type,
     Serial.print(" registering entity: ");
     Serial.print((short_name));
     Serial.print("/");
-    if (!custom_fullname.empty()) {
+    if (custom_fullname) {
         Serial.print(COLOR_BRIGHT_CYAN);
-        Serial.print(custom_fullname.c_str());
+        Serial.print(custom_fullname->c_str());
         Serial.print(COLOR_RESET);
     } else {
         Serial.print(Helpers::translated_word(fullname));
@@ -323,11 +325,14 @@ bool DeviceValue::get_min_max(int16_t & dv_set_min, uint32_t & dv_set_max) {
 
 // extract custom min from custom_fullname
 bool DeviceValue::get_custom_min(int16_t & val) {
-    auto    min_pos    = custom_fullname.find('>');
+    if (!custom_fullname) {
+        return false;
+    }
+    auto    min_pos    = custom_fullname->find('>');
     bool    has_min    = (min_pos != std::string::npos);
     uint8_t fahrenheit = !EMSESP::system_.fahrenheit() ? 0 : (uom == DeviceValueUOM::DEGREES) ? 2 : (uom == DeviceValueUOM::DEGREES_R) ? 1 : 0;
     if (has_min) {
-        int16_t v = Helpers::atoint(custom_fullname.substr(min_pos + 1).c_str());
+        int16_t v = Helpers::atoint(custom_fullname->substr(min_pos + 1).c_str());
         if (fahrenheit) {
             v = (v - (32 * (fahrenheit - 1))) / 1.8; // reset to °C
         }
@@ -341,11 +346,14 @@ bool DeviceValue::get_custom_min(int16_t & val) {
 
 // extract custom max from custom_fullname
 bool DeviceValue::get_custom_max(uint32_t & val) {
-    auto    max_pos    = custom_fullname.find('<');
+    if (!custom_fullname) {
+        return false;
+    }
+    auto    max_pos    = custom_fullname->find('<');
     bool    has_max    = (max_pos != std::string::npos);
     uint8_t fahrenheit = !EMSESP::system_.fahrenheit() ? 0 : (uom == DeviceValueUOM::DEGREES) ? 2 : (uom == DeviceValueUOM::DEGREES_R) ? 1 : 0;
     if (has_max) {
-        int32_t v = Helpers::atoint(custom_fullname.substr(max_pos + 1).c_str());
+        int32_t v = Helpers::atoint(custom_fullname->substr(max_pos + 1).c_str());
         if (fahrenheit) {
             v = (v - (32 * (fahrenheit - 1))) / 1.8; // reset to °C
         }
@@ -363,14 +371,26 @@ void DeviceValue::set_custom_minmax() {
     get_custom_max(max);
 }
 
+// sets the custom name including the optional custom min/max, an empty name frees it
+void DeviceValue::set_custom_fullname(const std::string & name) {
+    if (name.empty()) {
+        custom_fullname.reset();
+    } else {
+        custom_fullname.reset(new std::string(name));
+    }
+}
+
 std::string DeviceValue::get_custom_fullname() const {
-    auto min_pos    = custom_fullname.find('>');
-    auto max_pos    = custom_fullname.find('<');
+    if (!custom_fullname) {
+        return std::string();
+    }
+    auto min_pos    = custom_fullname->find('>');
+    auto max_pos    = custom_fullname->find('<');
     auto minmax_pos = min_pos < max_pos ? min_pos : max_pos;
     if (minmax_pos != std::string::npos) {
-        return custom_fullname.substr(0, minmax_pos);
+        return custom_fullname->substr(0, minmax_pos);
     }
-    return custom_fullname;
+    return *custom_fullname;
 }
 
 // returns the translated fullname or the custom fullname (if provided)
@@ -23,6 +23,8 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 
+#include <memory>
+
 #include "helpers.h"          // for conversions
 #include "default_settings.h" // for enum types
 
@@ -124,6 +126,7 @@ class DeviceValue {
         DV_ACTIVE            = (1 << 0), // 1 - has a validated real value
         DV_HA_CONFIG_CREATED = (1 << 1), // 2 - set if the HA config topic has been created
         DV_HA_CLIMATE_NO_RT  = (1 << 2), // 4 - climate created without roomTemp
+        DV_CHANGED           = (1 << 3), // 8 - changed since the last MQTT publish, used in delta mode
 
         // high nibble as mask for exclusions & special functions
         DV_WEB_EXCLUDE      = (1 << 4), // 16 - not shown on web
@@ -145,22 +148,28 @@ class DeviceValue {
         DV_NUMOP_MUL15  = -15
     };
 
-    uint8_t               device_type;    // EMSdevice::DeviceType
-    uint8_t               tag;            // DeviceValueTAG::*
-    void *                value_p;        // pointer to variable of any type
-    uint8_t               type;           // DeviceValueType::*
-    const char * const ** options;        // options as a flash char array
-    const char * const *  options_single; // options are not translated
-    int8_t                numeric_operator;
-    uint8_t               options_size;    // number of options in the char array, calculated
-    const char * const    short_name;      // used in MQTT and API
-    const char * const *  fullname;        // used in Web and Console, is translated
-    std::string           custom_fullname; // optional, from customization
-    uint8_t               uom;             // DeviceValueUOM::*
-    bool                  has_cmd;         // true if there is a Console/MQTT command which matches the short_name
-    int16_t               min;             // min range
-    uint32_t              max;             // max range
-    uint8_t               state;           // DeviceValueState::*
+    // a boiler or thermostat has hundreds of these, so keep it small: the names and options are
+    // pointers to the flash tables, the members are ordered to avoid padding and the custom
+    // fullname is only allocated for entities that have one
+    void *                       value_p;         // pointer to variable of any type
+    const char * const **        options;         // options as a flash char array
+    const char * const *         options_single;  // options are not translated
+    const char * const           short_name;      // used in MQTT and API
+    const char * const *         fullname;        // used in Web and Console, is translated
+    std::unique_ptr<std::string> custom_fullname; // optional, from customization
+    std::string                  mqtt_topic;      // cached topic for publish_single, built on first publish
+    uint32_t                     max;             // max range
+    uint32_t                     ha_config_hash;  // hash of the last published HA discovery config, 0 if none
+    int16_t                      min;             // min range
+    uint8_t                      device_type;     // EMSdevice::DeviceType
+    uint8_t                      tag;             // DeviceValueTAG::*
+    uint8_t                      type;            // DeviceValueType::*
+    int8_t                       numeric_operator;
+    uint8_t                      options_size;   // number of options in the char array, calculated
+    uint8_t                      uom;            // DeviceValueUOM::*
+    bool                         has_cmd;        // true if there is a Console/MQTT command which matches the short_name
+    uint8_t                      state;          // DeviceValueState::*
+    uint8_t                      mqtt_topic_fmt; // the Mqtt::topic_format() the cached topic was built with
 
     DeviceValue(uint8_t               device_type,
                 uint8_t               tag,
@@ -171,7 +180,7 @@ class DeviceValue {
                 int8_t                numeric_operator,
                 const char * const    short_name,
                 const char * const *  fullname,
-                std::string &         custom_fullname,
+                const std::string &   custom_fullname,
                 uint8_t               uom,
                 bool                  has_cmd,
                 int16_t               min,
@@ -182,6 +191,7 @@ class DeviceValue {
     bool has_tag() const;
     bool get_min_max(int16_t & dv_set_min, uint32_t & dv_set_max);
 
+    void               set_custom_fullname(const std::string & name);
     void               set_custom_minmax();
     bool               get_custom_min(int16_t & val);
     bool               get_custom_max(uint32_t & val);
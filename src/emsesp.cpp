@@ -44,7 +44,7 @@ WebCustomEntityService  EMSESP::webCustomEntityService  = WebCustomEntityService
 WebStatusService EMSESP::webStatusService = WebStatusService(&webServer, EMSESP::esp8266React.getSecurityManager());
 WebDataService   EMSESP::webDataService   = WebDataService(&webServer, EMSESP::esp8266React.getSecurityManager());
 WebAPIService    EMSESP::webAPIService    = WebAPIService(&webServer, EMSESP::esp8266React.getSecurityManager());
-WebLogService    EMSESP::webLogService    = WebLogService(&webServer, EMSESP::esp8266React.getSecurityManager());
+WebLogService    EMSESP::webLogService(&webServer, EMSESP::esp8266React.getSecurityManager()); // not movable, it holds a mutex
 
 using DeviceFlags = EMSdevice;
 using DeviceType  = EMSdevice::DeviceType;
@@ -52,18 +52,21 @@ using DeviceType  = EMSdevice::DeviceType;
 std::vector<std::unique_ptr<EMSdevice>> EMSESP::emsdevices;      // array of all the detected EMS devices
 std::vector<EMSESP::Device_record>      EMSESP::device_library_; // library of all our known EMS devices, in heap
 
+EMSdevice * EMSESP::emsdevice_lookup_[128] = {nullptr}; // active EMS device for each device_id, used to dispatch telegrams
+
 uuid::log::Logger EMSESP::logger_{F_(emsesp), uuid::log::Facility::KERN};
 uuid::log::Logger EMSESP::logger() {
     return logger_;
 }
 
-#ifndef EMSESP_STANDALONE
 uuid::syslog::SyslogService System::syslog_;
-#endif
 
 // The services
 RxService         EMSESP::rxservice_;         // incoming Telegram Rx handler
 TxService         EMSESP::txservice_;         // outgoing Telegram Tx handler
+BusCapture        EMSESP::buscapture_;        // black box recording of the Rx frames
+BusStats          EMSESP::busstats_;          // Tx latencies and bus load
+Profiler          EMSESP::profiler_;          // time spent in the loop services
 Mqtt              EMSESP::mqtt_;              // mqtt handler
 System            EMSESP::system_;            // core system services
 TemperatureSensor EMSESP::temperaturesensor_; // Temperature sensors
@@ -86,6 +89,10 @@ bool     EMSESP::trace_raw_        = false;
 uint16_t EMSESP::wait_validate_    = 0;
 bool     EMSESP::wait_km_          = true;
 
+uint32_t EMSESP::telegram_dispatch_hits_   = 0; // telegrams matched to a registered handler
+uint32_t EMSESP::telegram_dispatch_misses_ = 0; // telegrams without a handler
+uint32_t EMSESP::fetch_skipped_            = 0; // scheduled reads not needed
+
 // for a specific EMS device go and request data values
 // or if device_id is 0 it will fetch from all our known and active devices
 void EMSESP::fetch_device_values(const uint8_t device_id) {
@@ -276,22 +283,39 @@ void EMSESP::show_ems(uuid::console::Shell & shell) {
         shell.printfln("  #telegrams received: %d", rxservice_.telegram_count());
         shell.printfln("  #read requests sent: %d", txservice_.telegram_read_count());
         shell.printfln("  #write requests sent: %d", txservice_.telegram_write_count());
+        shell.printfln("  #read requests merged: %d", txservice_.telegram_merged_count());
+        shell.printfln("  #scheduled reads skipped: %d", fetch_skipped_);
         shell.printfln("  #incomplete telegrams: %d", rxservice_.telegram_error_count());
+        shell.printfln("  #dropped telegrams (Rx queue full): %d", rxservice_.telegram_overflow_count());
+        shell.printfln("  Rx queue high-water mark: %d/%d", rxservice_.queue_max(), MAX_RX_TELEGRAMS);
+        shell.printfln("  Telegram pool usage: %d, high-water mark: %d/%d, heap fallbacks: %d",
+                       TelegramPool::in_use(),
+                       TelegramPool::high_water(),
+                       TelegramPool::POOL_SIZE,
+                       TelegramPool::fallback_count());
+        shell.printfln("  Bus capture: %d telegrams recorded, %d in buffer (%d/%d bytes)",
+                       buscapture_.recorded(),
+                       buscapture_.records(),
+                       buscapture_.used(),
+                       BusCapture::CAPTURE_SIZE);
         shell.printfln("  #read fails (after %d retries): %d", TxService::MAXIMUM_TX_RETRIES, txservice_.telegram_read_fail_count());
         shell.printfln("  #write fails (after %d retries): %d", TxService::MAXIMUM_TX_RETRIES, txservice_.telegram_write_fail_count());
         shell.printfln("  Rx line quality: %d%%", rxservice_.quality());
         shell.printfln("  Tx line quality: %d%%", (txservice_.read_quality() + txservice_.read_quality()) / 2);
+        shell.printfln("  #telegram dispatch hits: %d", telegram_dispatch_hits_);
+        shell.printfln("  #telegram dispatch misses: %d", telegram_dispatch_misses_);
+        busstats_.show(shell);
         shell.println();
     }
 
     // Rx queue
-    auto rx_telegrams = rxservice_.queue();
-    if (rx_telegrams.empty()) {
+    auto rx_frames = rxservice_.queue();
+    if (rx_frames.empty()) {
         shell.printfln("Rx Queue is empty");
     } else {
-        shell.printfln("Rx Queue (%ld telegram%s):", rx_telegrams.size(), rx_telegrams.size() == 1 ? "" : "s");
-        for (const auto & it : rx_telegrams) {
-            shell.printfln(" [%02d] %s", it.id_, pretty_telegram(it.telegram_).c_str());
+        shell.printfln("Rx Queue (%ld telegram%s):", rx_frames.size(), rx_frames.size() == 1 ? "" : "s");
+        for (const auto & it : rx_frames) {
+            shell.printfln(" [%02d] %s", it.id_, Helpers::data_to_hex(it.data_, it.length_).c_str());
         }
     }
 
@@ -431,6 +455,9 @@ void EMSESP::show_sensor_values(uuid::console::Shell & shell) {
             } else {
                 shell.printfln("  %s (offset %s, ID: %s)", sensor.name().c_str(), Helpers::render_value(s, sensor.offset(), 10, fahrenheit), sensor.id().c_str());
             }
+            if (sensor.crc_fails || sensor.retries) {
+                shell.printfln("    CRC fails: %d, retries: %d", sensor.crc_fails, sensor.retries);
+            }
         }
         shell.println();
     }
@@ -534,13 +561,14 @@ void EMSESP::publish_all_loop() {
 
 // force HA to re-create all the devices next time they are detected
 // also removes the old HA topics
-void EMSESP::reset_mqtt_ha() {
+// device entity configs that are unchanged since the last publish are not sent again, unless forced
+void EMSESP::reset_mqtt_ha(const bool force) {
     if (!Mqtt::ha_enabled()) {
         return;
     }
 
     for (const auto & emsdevice : emsdevices) {
-        emsdevice->ha_config_clear();
+        emsdevice->ha_config_clear(force);
     }
 
     // force the re-creating of the temperature and analog sensor topics (for HA)
@@ -548,6 +576,16 @@ void EMSESP::reset_mqtt_ha() {
     analogsensor_.reload();
 }
 
+// clear the config hashes that are not in the sorted list of retained configs, so these are published again
+// returns the number of configs to publish again
+uint16_t EMSESP::verify_mqtt_ha(const std::vector<uint32_t> & retained) {
+    uint16_t missing = 0;
+    for (const auto & emsdevice : emsdevices) {
+        missing += emsdevice->ha_config_verify(retained);
+    }
+    return missing;
+}
+
 // create json doc for the devices values and add to MQTT publish queue
 // this will also create the HA /config topic for each device value
 // generate_values_json is called to build the device value (dv) object array
@@ -556,20 +594,27 @@ void EMSESP::publish_device_values(uint8_t device_type) {
     JsonObject          json         = doc.to<JsonObject>();
     bool                need_publish = false;
     bool                nested       = (Mqtt::is_nested());
+    bool                changed_only = Mqtt::publish_delta() && !publish_all_idx_; // delta mode, except when publishing all
 
     // group by device type
     for (uint8_t tag = DeviceValueTAG::TAG_BOILER_DATA_WW; tag <= DeviceValueTAG::TAG_HS16; tag++) {
         JsonObject json_hc      = json;
         bool       nest_created = false;
+        bool       tag_values   = false;
         for (const auto & emsdevice : emsdevices) {
             if (emsdevice && (emsdevice->device_type() == device_type)) {
                 if (nested && !nest_created && emsdevice->has_tags(tag)) {
                     json_hc      = doc.createNestedObject(EMSdevice::tag_to_mqtt(tag));
                     nest_created = true;
                 }
-                need_publish |= emsdevice->generate_values(json_hc, tag, false, EMSdevice::OUTPUT_TARGET::MQTT);
+                tag_values |= emsdevice->generate_values(json_hc, tag, false, EMSdevice::OUTPUT_TARGET::MQTT, changed_only);
             }
         }
+        // in delta mode a circuit without changes is left out, instead of publishing an empty object
+        if (changed_only && nest_created && !tag_values) {
+            json.remove(EMSdevice::tag_to_mqtt(tag));
+        }
+        need_publish |= tag_values;
         if (need_publish && ((!nested && tag >= DeviceValueTAG::TAG_DEVICE_DATA_WW) || (tag == DeviceValueTAG::TAG_BOILER_DATA_WW))) {
             Mqtt::queue_publish(Mqtt::tag_to_topic(device_type, tag), json);
             json         = doc.to<JsonObject>();
@@ -911,39 +956,47 @@ bool EMSESP::process_telegram(std::shared_ptr<const Telegram> telegram) {
         return true;
     }
 
-    // match device_id and type_id
+    // match device_id and type_id using the lookup table
     // calls the associated process function for that EMS device
     // returns false if the device_id doesn't recognize it
     // after the telegram has been processed, see if there have been values changed and we need to do a MQTT publish
-    bool found       = false;
-    bool knowndevice = false;
-    for (const auto & emsdevice : emsdevices) {
-        if (emsdevice->is_device_id(telegram->src)) {
-            knowndevice = true;
-            found       = emsdevice->handle_telegram(telegram);
-            // if we correctly processed the telegram then follow up with sending it via MQTT (if enabled)
-            if (found && Mqtt::connected()) {
-                if ((mqtt_.get_publish_onchange(emsdevice->device_type()) && emsdevice->has_update())
-                    || (telegram->type_id == publish_id_ && telegram->dest == txservice_.ems_bus_id())) {
-                    if (telegram->type_id == publish_id_) {
-                        publish_id_ = 0;
-                    }
-                    emsdevice->has_update(false); // reset flag
-                    if (!Mqtt::publish_single()) {
-                        publish_device_values(emsdevice->device_type()); // publish to MQTT if we explicitly have too
-                    }
+    bool        found       = false;
+    EMSdevice * emsdevice   = emsdevice_lookup_[telegram->src & 0x7F];
+    bool        knowndevice = (emsdevice != nullptr);
+    if (emsdevice) {
+        found = emsdevice->handle_telegram(telegram);
+        // if we correctly processed the telegram then follow up with sending it via MQTT (if enabled)
+        if (found && Mqtt::connected()) {
+            if ((mqtt_.get_publish_onchange(emsdevice->device_type()) && emsdevice->has_update())
+                || (telegram->type_id == publish_id_ && telegram->dest == txservice_.ems_bus_id())) {
+                if (telegram->type_id == publish_id_) {
+                    publish_id_ = 0;
+                }
+                emsdevice->has_update(false); // reset flag
+                if (!Mqtt::publish_single()) {
+                    publish_device_values(emsdevice->device_type()); // publish to MQTT if we explicitly have too
                 }
             }
-            if (wait_validate_ == telegram->type_id) {
-                wait_validate_ = 0;
-            }
-            if (!found && telegram->message_length > 0) {
-                emsdevice->add_handlers_ignored(telegram->type_id);
-            }
-            break;
-        } else if (emsdevice->is_device_id(telegram->dest)) {
-            emsdevice->handle_telegram(telegram);
         }
+        if (wait_validate_ == telegram->type_id) {
+            wait_validate_ = 0;
+        }
+        if (!found && telegram->message_length > 0) {
+            emsdevice->add_handlers_ignored(telegram->type_id);
+        }
+    }
+
+    // the destination device may also read telegrams sent to it, e.g. the boiler reading setpoints from the thermostat
+    // emsdevices is sorted by device type, so like before only a destination ordered before the sender gets it
+    EMSdevice * dest_device = telegram->dest ? emsdevice_lookup_[telegram->dest & 0x7F] : nullptr;
+    if (dest_device && dest_device != emsdevice && (!knowndevice || dest_device->device_type() < emsdevice->device_type())) {
+        dest_device->handle_telegram(telegram);
+    }
+
+    if (found) {
+        telegram_dispatch_hits_++;
+    } else {
+        telegram_dispatch_misses_++;
     }
 
     // handle unknown broadcasted telegrams
@@ -962,13 +1015,7 @@ bool EMSESP::process_telegram(std::shared_ptr<const Telegram> telegram) {
 
 // return true if we have this device already registered
 bool EMSESP::device_exists(const uint8_t device_id) {
-    for (const auto & emsdevice : emsdevices) {
-        if (emsdevice && emsdevice->is_device_id(device_id)) {
-            return true;
-        }
-    }
-
-    return false; // not found
+    return (emsdevice_lookup_[device_id & 0x7F] != nullptr);
 }
 
 // for each associated EMS device go and get its system information
@@ -1074,6 +1121,7 @@ bool EMSESP::add_device(const uint8_t device_id, const uint8_t product_id, const
         LOG_NOTICE("Unrecognized EMS device (deviceID 0x%02X, productID %d). Please report on GitHub.", device_id, product_id);
         emsdevices.push_back(
             EMSFactory::add(DeviceType::GENERIC, device_id, product_id, version, "unknown", DeviceFlags::EMS_DEVICE_FLAG_NONE, EMSdevice::Brand::NO_BRAND));
+        emsdevice_lookup_[device_id & 0x7F] = emsdevices.back().get();
         return false; // not found
     }
 
@@ -1146,6 +1194,8 @@ bool EMSESP::add_device(const uint8_t device_id, const uint8_t product_id, const
 
     LOG_DEBUG("Adding new device %s (deviceID 0x%02X, productID %d, version %s)", name, device_id, product_id, version);
     emsdevices.push_back(EMSFactory::add(device_type, device_id, product_id, version, name, flags, brand));
+    emsdevices.back()->shrink_to_fit();
+    emsdevice_lookup_[device_id & 0x7F] = emsdevices.back().get(); // pointer stays valid when the list is sorted
 
     // assign a unique ID. Note that this is not actual unique after a restart as it's dependent on the order that devices are found
     // can't be 0 otherwise web won't work
@@ -1288,6 +1338,8 @@ void EMSESP::incoming_telegram(uint8_t * data, const uint8_t length) {
 #ifdef EMSESP_UART_DEBUG
     static uint32_t rx_time_ = 0;
 #endif
+    busstats_.rx_frame(length);
+
     // check first for echo
     uint8_t first_value = data[0];
     if (((first_value & 0x7F) == txservice_.ems_bus_id()) && (length > 1)) {
@@ -1313,6 +1365,7 @@ void EMSESP::incoming_telegram(uint8_t * data, const uint8_t length) {
             if (first_value == TxService::TX_WRITE_SUCCESS) {
                 LOG_DEBUG("Last Tx write successful");
                 txservice_.increment_telegram_write_count(); // last tx/write was confirmed ok
+                busstats_.tx_done();
                 txservice_.send_poll();                      // close the bus
                 publish_id_ = txservice_.post_send_query();  // follow up with any post-read if set
                 txservice_.reset_retry_count();
@@ -1331,6 +1384,7 @@ void EMSESP::incoming_telegram(uint8_t * data, const uint8_t length) {
             if (txservice_.is_last_tx(src, dest)) {
                 LOG_DEBUG("Last Tx read successful");
                 txservice_.increment_telegram_read_count();
+                busstats_.tx_done();
                 txservice_.reset_retry_count();
                 tx_successful = true;
 
@@ -1411,7 +1465,7 @@ void EMSESP::scheduled_fetch_values() {
             uint8_t i = 0;
             for (const auto & emsdevice : emsdevices) {
                 if (++i >= no) {
-                    emsdevice->fetch_values();
+                    fetch_skipped_ += emsdevice->fetch_values(true);
                     no++;
                     return;
                 }
@@ -1534,24 +1588,39 @@ void EMSESP::start() {
 }
 
 // main loop calling all services
+// each service is timed by the profiler, lap() returns the start time of the next one
 void EMSESP::loop() {
+    uint32_t loop_start = micros();
+    uint32_t t          = loop_start;
+
     esp8266React.loop(); // web services
-    system_.loop();      // does LED and checks system health, and syslog service
+    t = profiler_.lap(Profiler::WEB, t);
+    system_.loop(); // does LED and checks system health, and syslog service
+    t = profiler_.lap(Profiler::SYSTEM, t);
 
     // if we're doing an OTA upload, skip everything except from console refresh
     if (!system_.upload_status()) {
         // service loops
-        webLogService.loop();       // log in Web UI
-        rxservice_.loop();          // process any incoming Rx telegrams
-        shower_.loop();             // check for shower on/off
-        temperaturesensor_.loop();  // read sensor temperatures
-        analogsensor_.loop();       // read analog sensor values
-        publish_all_loop();         // with HA messages in parts to avoid flooding the mqtt queue
-        mqtt_.loop();               // sends out anything in the MQTT queue
+        webLogService.loop(); // log in Web UI
+        t = profiler_.lap(Profiler::WEBLOG, t);
+        rxservice_.loop(); // process any incoming Rx telegrams
+        t = profiler_.lap(Profiler::RX, t);
+        shower_.loop(); // check for shower on/off
+        t = profiler_.lap(Profiler::SHOWER, t);
+        temperaturesensor_.loop(); // read sensor temperatures
+        t = profiler_.lap(Profiler::TEMPERATURESENSOR, t);
+        analogsensor_.loop(); // read analog sensor values
+        t = profiler_.lap(Profiler::ANALOGSENSOR, t);
+        publish_all_loop(); // with HA messages in parts to avoid flooding the mqtt queue
+        t = profiler_.lap(Profiler::PUBLISH, t);
+        mqtt_.loop(); // sends out anything in the MQTT queue
+        t = profiler_.lap(Profiler::MQTT, t);
         webSchedulerService.loop(); // handle any scheduled jobs
+        t = profiler_.lap(Profiler::SCHEDULER, t);
 
         // force a query on the EMS devices to fetch latest data at a set interval (1 min)
         scheduled_fetch_values();
+        t = profiler_.lap(Profiler::FETCH, t);
     }
 
     uuid::loop();
@@ -1567,6 +1636,8 @@ void EMSESP::loop() {
 #endif
 
     Shell::loop_all();
+    profiler_.lap(Profiler::CONSOLE, t);
+    profiler_.lap(Profiler::LOOP, loop_start);
 }
 
 } // namespace emsesp
@@ -26,6 +26,7 @@
 #include <deque>
 #include <unordered_map>
 #include <list>
+#include <mutex>
 
 #include <ArduinoJson.h>
 
@@ -53,6 +54,9 @@
 #include "emsdevice.h"
 #include "emsfactory.h"
 #include "telegram.h"
+#include "buscapture.h"
+#include "busstats.h"
+#include "profiler.h"
 #include "mqtt.h"
 #include "system.h"
 #include "temperaturesensor.h"
@@ -106,7 +110,8 @@ class EMSESP {
     static void publish_other_values();
     static void publish_sensor_values(const bool time, const bool force = false);
     static void publish_all(bool force = false);
-    static void reset_mqtt_ha();
+    static void     reset_mqtt_ha(const bool force = false);
+    static uint16_t verify_mqtt_ha(const std::vector<uint32_t> & retained);
 
 #ifdef EMSESP_STANDALONE
     static void run_test(uuid::console::Shell & shell, const std::string & command); // only for testing
@@ -218,6 +223,18 @@ class EMSESP {
 
     static std::vector<std::unique_ptr<EMSdevice>> emsdevices;
 
+    static uint32_t telegram_dispatch_hits() {
+        return telegram_dispatch_hits_;
+    }
+    static uint32_t telegram_dispatch_misses() {
+        return telegram_dispatch_misses_;
+    }
+    static uint32_t fetch_skipped() {
+        return fetch_skipped_;
+    }
+
+    static constexpr uint32_t EMS_FETCH_FREQUENCY = 60000; // check every minute
+
     // services
     static Mqtt              mqtt_;
     static System            system_;
@@ -226,6 +243,9 @@ class EMSESP {
     static Shower            shower_;
     static RxService         rxservice_;
     static TxService         txservice_;
+    static BusCapture        buscapture_;
+    static BusStats          busstats_;
+    static Profiler          profiler_;
     static Preferences       nvs_;
 
     // web controllers
@@ -249,8 +269,7 @@ class EMSESP {
     static bool        command_commands(uint8_t device_type, JsonObject & output, const int8_t id);
     static bool        command_entities(uint8_t device_type, JsonObject & output, const int8_t id);
 
-    static constexpr uint32_t EMS_FETCH_FREQUENCY = 60000; // check every minute
-    static constexpr uint8_t  EMS_WAIT_KM_TIMEOUT = 60;    // wait one minute
+    static constexpr uint8_t EMS_WAIT_KM_TIMEOUT = 60; // wait one minute
 
     struct Device_record {
         uint8_t               product_id;
@@ -260,6 +279,12 @@ class EMSESP {
     };
     static std::vector<Device_record> device_library_;
 
+    // direct lookup of the active EMS device by its 7-bit device_id, filled in add_device()
+    static EMSdevice * emsdevice_lookup_[128];
+    static uint32_t    telegram_dispatch_hits_;
+    static uint32_t    telegram_dispatch_misses_;
+    static uint32_t    fetch_skipped_;
+
     static uint16_t watch_id_;
     static uint8_t  watch_;
     static uint16_t read_id_;
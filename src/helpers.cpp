@@ -594,21 +594,20 @@ bool Helpers::value2string(const char * value, std::string & value_s) {
 
 // checks to see if a string (usually a command or payload cmd) looks like a boolean
 // on, off, true, false, 1, 0
+// compares case-insensitive in place, without lowering the value into a std::string
 bool Helpers::value2bool(const char * value, bool & value_b) {
-    if ((value == nullptr) || (strlen(value) == 0)) {
+    if ((value == nullptr) || (value[0] == '\0')) {
         return false;
     }
 
-    std::string bool_str = toLower(value);
-
-    if ((bool_str == std::string(Helpers::translated_word(FL_(on)))) || (bool_str == toLower(Helpers::translated_word(FL_(ON)))) || (bool_str == "on")
-        || (bool_str == "1") || (bool_str == "true")) {
+    if (!strcasecmp(value, Helpers::translated_word(FL_(on))) || !strcasecmp(value, Helpers::translated_word(FL_(ON))) || !strcasecmp(value, "on")
+        || !strcmp(value, "1") || !strcasecmp(value, "true")) {
         value_b = true;
         return true; // is a bool
     }
 
-    if ((bool_str == std::string(Helpers::translated_word(FL_(off)))) || (bool_str == toLower(Helpers::translated_word(FL_(OFF)))) || (bool_str == "off")
-        || (bool_str == "0") || (bool_str == "false")) {
+    if (!strcasecmp(value, Helpers::translated_word(FL_(off))) || !strcasecmp(value, Helpers::translated_word(FL_(OFF))) || !strcasecmp(value, "off")
+        || !strcmp(value, "0") || !strcasecmp(value, "false")) {
         value_b = false;
         return true; // is a bool
     }
@@ -619,17 +618,16 @@ bool Helpers::value2bool(const char * value, bool & value_b) {
 // checks to see if a string is member of a vector and return the index, also allow true/false for on/off
 // this for a list of lists, when using translated strings
 bool Helpers::value2enum(const char * value, uint8_t & value_ui, const char * const ** strs) {
-    if ((value == nullptr) || (strlen(value) == 0)) {
+    if ((value == nullptr) || (value[0] == '\0')) {
         return false;
     }
-    std::string str = toLower(value);
 
     for (value_ui = 0; strs[value_ui]; value_ui++) {
-        std::string str1 = toLower(std::string(Helpers::translated_word(strs[value_ui])));
-        std::string str2 = toLower((strs[value_ui][0])); // also check for default language
-        if ((str1 != "")
-            && ((str2 == "off" && str == "false") || (str2 == "on" && str == "true") || (str == str1) || (str == str2)
-                || (value[0] == ('0' + value_ui) && value[1] == '\0'))) {
+        const char * str1 = Helpers::translated_word(strs[value_ui]);
+        const char * str2 = strs[value_ui][0]; // also check for default language
+        if ((str1[0] != '\0')
+            && ((!strcasecmp(str2, "off") && !strcasecmp(value, "false")) || (!strcasecmp(str2, "on") && !strcasecmp(value, "true"))
+                || !strcasecmp(value, str1) || !strcasecmp(value, str2) || (value[0] == ('0' + value_ui) && value[1] == '\0'))) {
             return true;
         }
     }
@@ -641,21 +639,21 @@ bool Helpers::value2enum(const char * value, uint8_t & value_ui, const char * co
 // returns true if found, and sets the value_ui to the index, else false
 // also allow true/false for on/off
 bool Helpers::value2enum(const char * value, uint8_t & value_ui, const char * const * strs) {
-    if ((value == nullptr) || (strlen(value) == 0)) {
+    if ((value == nullptr) || (value[0] == '\0')) {
         return false;
     }
-    std::string str = toLower(value);
 
-    std::string s_on  = Helpers::translated_word(FL_(on));
-    std::string s_off = Helpers::translated_word(FL_(off));
+    const char * s_on  = Helpers::translated_word(FL_(on));
+    const char * s_off = Helpers::translated_word(FL_(off));
 
     // stops when a nullptr is found, which is the end delimeter of a MAKE_TRANSLATION()
     // could use count_items() to avoid buffer over-run but this works
     for (value_ui = 0; strs[value_ui]; value_ui++) {
-        std::string enum_str = toLower((strs[value_ui]));
+        const char * enum_str = strs[value_ui];
 
-        if ((enum_str != "")
-            && ((enum_str == "off" && (str == s_off || str == "false")) || (enum_str == "on" && (str == s_on || str == "true")) || (str == enum_str)
+        if ((enum_str[0] != '\0')
+            && ((!strcasecmp(enum_str, "off") && (!strcasecmp(value, s_off) || !strcasecmp(value, "false")))
+                || (!strcasecmp(enum_str, "on") && (!strcasecmp(value, s_on) || !strcasecmp(value, "true"))) || !strcasecmp(value, enum_str)
                 || (value[0] == ('0' + value_ui) && value[1] == '\0'))) {
             return true;
         }
@@ -772,18 +770,27 @@ uint8_t Helpers::count_items(const char * const ** list) {
 // returns char pointer to translated description or fullname
 // if force_en is true always take the EN non-translated word
 const char * Helpers::translated_word(const char * const * strings, const bool force_en) {
-    uint8_t language_index = EMSESP::system_.language_index();
-    uint8_t index          = 0;
-
     if (!strings) {
         return ""; // no translations
     }
 
-    // see how many translations we have for this entity. if there is no translation for this, revert to EN
-    if (!force_en && (Helpers::count_items(strings) >= language_index + 1 && strlen(strings[language_index]))) {
-        index = language_index;
+#ifndef EMSESP_SINGLE_LANGUAGE
+    uint8_t language_index = EMSESP::system_.language_index();
+    if (!force_en && language_index) {
+        // see if we have a translation for this entity, the list ends with a nullptr. if not, revert to EN
+        for (uint8_t i = 1; i <= language_index; i++) {
+            if (!strings[i]) {
+                return strings[0];
+            }
+        }
+        if (strings[language_index][0]) {
+            return strings[language_index];
+        }
     }
-    return strings[index];
+#else
+    (void)force_en;
+#endif
+    return strings[0];
 }
 
 uint16_t Helpers::string2minutes(const std::string & str) {
@@ -46,6 +46,9 @@ MAKE_WORD(watch)
 MAKE_WORD(syslog)
 MAKE_WORD(send)
 MAKE_WORD(telegram)
+MAKE_WORD(capture)
+MAKE_WORD(busstats)
+MAKE_WORD(profile)
 MAKE_WORD(bus_id)
 MAKE_WORD(tx_mode)
 MAKE_WORD(ems)
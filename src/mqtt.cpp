@@ -46,18 +46,31 @@ uint8_t     Mqtt::discovery_type_;
 bool        Mqtt::send_response_;
 bool        Mqtt::publish_single_;
 bool        Mqtt::publish_single2cmd_;
+bool        Mqtt::publish_delta_;
 
 std::vector<Mqtt::MQTTSubFunction> Mqtt::mqtt_subfunctions_;
-
-uint32_t Mqtt::mqtt_publish_fails_ = 0;
-bool     Mqtt::connecting_         = false;
-bool     Mqtt::initialized_        = false;
-bool     Mqtt::ha_climate_reset_   = false;
-uint16_t Mqtt::queuecount_         = 0;
-uint8_t  Mqtt::connectcount_       = 0;
-uint32_t Mqtt::mqtt_message_id_    = 0;
+std::vector<Mqtt::MQTTRoute>       Mqtt::mqtt_routes_;
+
+uint32_t Mqtt::mqtt_publish_fails_       = 0;
+uint32_t Mqtt::ha_configs_published_     = 0;
+uint32_t Mqtt::ha_configs_unchanged_     = 0;
+uint32_t Mqtt::publish_buffer_fallbacks_ = 0;
+bool     Mqtt::connecting_               = false;
+bool     Mqtt::initialized_              = false;
+bool     Mqtt::ha_climate_reset_         = false;
+uint16_t Mqtt::queuecount_               = 0;
+uint8_t  Mqtt::connectcount_             = 0;
+uint32_t Mqtt::mqtt_message_id_          = 0;
 char     will_topic_[Mqtt::MQTT_TOPIC_MAX_SIZE]; // because MQTT library keeps only char pointer
 
+char       Mqtt::publish_buffer_[Mqtt::MQTT_PUBLISH_BUFFER];
+std::mutex Mqtt::publish_mutex_;
+
+std::string           Mqtt::ha_broker_;
+uint32_t              Mqtt::ha_verify_start_ = 0;
+std::vector<uint32_t> Mqtt::ha_retained_;
+std::mutex            Mqtt::ha_retained_mutex_;
+
 std::string Mqtt::lasttopic_    = "";
 std::string Mqtt::lastpayload_  = "";
 std::string Mqtt::lastresponse_ = "";
@@ -95,6 +108,7 @@ void Mqtt::subscribe(const uint8_t device_type, const std::string & topic, mqtt_
     // register in our libary with the callback function.
     // We store the original topic string without base
     mqtt_subfunctions_.emplace_back(device_type, std::move(topic), std::move(cb));
+    add_route(device_type, topic, mqtt_subfunctions_.size() - 1);
 
     if (!enabled() || !connected()) {
         return;
@@ -104,6 +118,38 @@ void Mqtt::subscribe(const uint8_t device_type, const std::string & topic, mqtt_
     queue_subscribe_message(topic);
 }
 
+// add the segments of a subscribed topic (without base) to the router
+void Mqtt::add_route(const uint8_t device_type, const std::string & topic, const int16_t subfunction) {
+    uint16_t node  = ROUTE_ROOT;
+    size_t   start = 0;
+    while (start <= topic.size()) {
+        size_t end = topic.find('/', start);
+        if (end == std::string::npos) {
+            end = topic.size();
+        }
+        int16_t next = find_route(node, topic.c_str() + start, end - start);
+        if (next < 0) {
+            mqtt_routes_.push_back({topic.substr(start, end - start), node, device_type, -1});
+            next = mqtt_routes_.size() - 1;
+        }
+        node  = next;
+        start = end + 1;
+    }
+    mqtt_routes_[node].device_type_ = device_type;
+    mqtt_routes_[node].subfunction_ = subfunction;
+}
+
+// find the node for a topic segment below parent, segment is not terminated
+int16_t Mqtt::find_route(const uint16_t parent, const char * segment, const size_t len) {
+    for (uint16_t i = 0; i < mqtt_routes_.size(); i++) {
+        const auto & route = mqtt_routes_[i];
+        if (route.parent_ == parent && route.segment_.size() == len && !strncmp(route.segment_.c_str(), segment, len)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
 // subscribe without storing to subfunctions
 void Mqtt::subscribe(const std::string & topic) {
     // add to MQTT queue as a subscribe operation
@@ -144,11 +190,23 @@ void Mqtt::loop() {
         EMSESP::publish_sensor_values(false);
     }
 
+    // done collecting the retained discovery configs after a reconnect
+    if (ha_verify_start_ && (currentMillis - ha_verify_start_ > MQTT_HA_VERIFY_TIME)) {
+        ha_verify_done();
+    }
+
     // wait for empty queue before sending scheduled device messages
     if (queuecount_ > 0) {
         return;
     }
 
+    // in delta mode the device payloads only hold changed values, so refresh everything now and then
+    if (publish_delta() && (currentMillis - last_publish_full_ > MQTT_DELTA_REFRESH)) {
+        last_publish_full_ = currentMillis;
+        EMSESP::publish_all(true);
+        return;
+    }
+
     // create publish messages for each of the EMS device values, adding to queue, only one device per loop
     if (publish_time_boiler_ && (currentMillis - last_publish_boiler_ > publish_time_boiler_)) {
         last_publish_boiler_ = (currentMillis / publish_time_boiler_) * publish_time_boiler_;
@@ -182,6 +240,21 @@ void Mqtt::loop() {
     }
 }
 
+// stop collecting the retained discovery configs, configs the broker did not send back are published again
+void Mqtt::ha_verify_done() {
+    std::vector<uint32_t> retained;
+    {
+        std::lock_guard<std::mutex> lock(ha_retained_mutex_);
+        ha_verify_start_ = 0;
+        retained.swap(ha_retained_);
+    }
+    queue_unsubscribe_message(discovery_prefix_ + "/+/" + mqtt_basename_ + "/#");
+
+    std::sort(retained.begin(), retained.end());
+    uint16_t missing = EMSESP::verify_mqtt_ha(retained);
+    LOG_DEBUG("HA discovery: %d retained configs on the broker, %d missing", (int)retained.size(), (int)missing);
+}
+
 // print MQTT log and other stuff to console
 void Mqtt::show_mqtt(uuid::console::Shell & shell) {
     shell.printfln("MQTT is %s", connected() ? F_(connected) : F_(disconnected));
@@ -189,6 +262,10 @@ void Mqtt::show_mqtt(uuid::console::Shell & shell) {
 
     shell.printfln("MQTT publish errors: %lu", mqtt_publish_fails_);
     shell.printfln("MQTT queue: %d", queuecount_);
+    if (ha_enabled_) {
+        shell.printfln("MQTT HA discovery configs: %lu published, %lu unchanged", ha_configs_published_, ha_configs_unchanged_);
+    }
+    shell.printfln("MQTT payloads too large for the publish buffer: %lu", publish_buffer_fallbacks_);
     shell.println();
 
     // show subscriptions
@@ -233,6 +310,12 @@ void Mqtt::on_message(const char * topic, const uint8_t * payload, size_t len) c
         if (!ha_enabled_ && len) { // don't ping pong the empty message
             queue_publish_message(topic, "", true);
             LOG_DEBUG("Remove topic %s", topic);
+        } else if (ha_enabled_ && len) {
+            // a retained config sent back after a reconnect, a config split over several messages does not match and is sent again
+            std::lock_guard<std::mutex> lock(ha_retained_mutex_);
+            if (ha_verify_start_) {
+                ha_retained_.push_back(hash_config(topic, message, len));
+            }
         }
         return;
     }
@@ -244,20 +327,11 @@ void Mqtt::on_message(const char * topic, const uint8_t * payload, size_t len) c
     }
 
     // check first against any of our subscribed topics
-    for (const auto & mf : mqtt_subfunctions_) {
-        // add the base back
-        char full_topic[MQTT_TOPIC_MAX_SIZE];
-        snprintf(full_topic, sizeof(full_topic), "%s/%s", mqtt_base_.c_str(), mf.topic_.c_str());
-
-        if ((!strcmp(topic, full_topic)) && (mf.mqtt_subfunction_)) {
-            if (!(mf.mqtt_subfunction_)(message)) {
-                LOG_ERROR("error: invalid payload %s for this topic %s", message, topic);
-                Mqtt::queue_publish("response", "error: invalid data");
-            }
-            return;
-        }
+    if (route_message(topic, message)) {
+        return;
     }
 
+    // everything else goes through the full command parser
     StaticJsonDocument<EMSESP_JSON_SIZE_SMALL> input_doc;
     DynamicJsonDocument                        output_doc(EMSESP_JSON_SIZE_XLARGE);
     JsonObject                                 input, output;
@@ -276,7 +350,86 @@ void Mqtt::on_message(const char * topic, const uint8_t * payload, size_t len) c
     input               = input_doc.as<JsonObject>();
     output              = output_doc.to<JsonObject>();
     uint8_t return_code = Command::process(topic, true, input, output); // mqtt is always authenticated
+    command_response(return_code, output);
+}
+
+// walk the topic segments through the router
+// a topic with a callback is handled directly, a device topic (<base>/<device>/[hc/]<cmd>) with a plain value
+// calls the command without parsing the payload as json
+// returns false if the message needs the full command parser (json payloads, queries, references to other entities)
+bool Mqtt::route_message(const char * topic, const char * message) const {
+    if (strncmp(topic, mqtt_base_.c_str(), mqtt_base_.length()) || topic[mqtt_base_.length()] != '/') {
+        return false;
+    }
+
+    const char * segment  = topic + mqtt_base_.length() + 1;
+    const char * command  = nullptr; // rest of the topic after a device
+    int16_t      wildcard = -1;
+    uint16_t     node     = ROUTE_ROOT;
+    while (true) {
+        const char * end = strchr(segment, '/');
+        size_t       len = end ? end - segment : strlen(segment);
+
+        // a # below the current node takes the rest of the topic
+        int16_t w = find_route(node, "#", 1);
+        if (w >= 0) {
+            wildcard = w;
+            command  = segment;
+        }
+
+        int16_t next = find_route(node, segment, len);
+        if (next < 0) {
+            break;
+        }
+        node = next;
+
+        if (end == nullptr) {
+            const auto & route = mqtt_routes_[node];
+            if (route.subfunction_ >= 0 && mqtt_subfunctions_[route.subfunction_].mqtt_subfunction_) {
+                if (!(mqtt_subfunctions_[route.subfunction_].mqtt_subfunction_)(message)) {
+                    LOG_ERROR("error: invalid payload %s for this topic %s", message, topic);
+                    Mqtt::queue_publish("response", "error: invalid data");
+                }
+                return true;
+            }
+            break;
+        }
+        segment = end + 1;
+    }
+
+    // the command can be cmd, hc1/cmd or hc1/cmd/attribute, and the value a plain string
+    if (wildcard < 0 || !strlen(message) || strpbrk(message, "{/") != nullptr || strpbrk(command, "?=&") != nullptr || strlen(command) >= 50) {
+        return false;
+    }
+    uint8_t slashes = 0;
+    for (const char * p = command; *p; p++) {
+        if (*p == '/' && (++slashes > 2 || p == command || p[1] == '/' || p[1] == '\0')) {
+            return false;
+        }
+    }
 
+    uint8_t      device_type = mqtt_routes_[wildcard].device_type_;
+    int8_t       id          = -1;
+    const char * cmd         = Command::parse_command_string(command, id);
+    if (cmd == nullptr || !Command::device_has_commands(device_type)) {
+        return false;
+    }
+
+    // json commands can return more than fits here
+    auto cf = Command::find_command(device_type, 0, cmd);
+    if (cf && cf->cmdfunction_json_) {
+        return false;
+    }
+
+    StaticJsonDocument<EMSESP_JSON_SIZE_SMALL> output_doc;
+    JsonObject                                 output      = output_doc.to<JsonObject>();
+    uint8_t                                    return_code = Command::call(device_type, cmd, message, true, id, output); // mqtt is always authenticated
+    command_response(return_code, output);
+    return true;
+}
+
+// publish the result of a command to the response topic
+void Mqtt::command_response(const uint8_t return_code, const JsonObject & output) {
     if (return_code != CommandRet::OK) {
         char error[100];
         if (output.size()) {
@@ -340,6 +493,7 @@ void Mqtt::load_settings() {
         nested_format_      = mqttSettings.nested_format;
         publish_single_     = mqttSettings.publish_single;
         publish_single2cmd_ = mqttSettings.publish_single2cmd;
+        publish_delta_      = mqttSettings.publish_delta;
         send_response_      = mqttSettings.send_response;
         discovery_prefix_   = mqttSettings.discovery_prefix.c_str();
         entity_format_      = mqttSettings.entity_format;
@@ -489,9 +643,25 @@ void Mqtt::on_connect() {
     load_settings(); // reload MQTT settings - in case they have changes
 
     if (ha_enabled_) {
-        queue_unsubscribe_message(discovery_prefix_ + "/+/" + mqtt_basename_ + "/#");
-        EMSESP::reset_mqtt_ha(); // re-create all HA devices if there are any
-        ha_status();             // create the EMS-ESP device in HA, which is MQTT retained
+        char broker[80];
+        EMSESP::esp8266React.getMqttSettingsService()->read(
+            [&](MqttSettings & mqttSettings) { snprintf(broker, sizeof(broker), "%s:%u", mqttSettings.host.c_str(), mqttSettings.port); });
+        if (broker != ha_broker_) {
+            // first connect after boot or to another broker, publish all configs
+            ha_broker_ = broker;
+            queue_unsubscribe_message(discovery_prefix_ + "/+/" + mqtt_basename_ + "/#");
+            EMSESP::reset_mqtt_ha(true);
+        } else {
+            // keep the config hashes, the broker sends back the retained configs and ha_verify_done() clears the missing ones
+            {
+                std::lock_guard<std::mutex> lock(ha_retained_mutex_);
+                ha_retained_.clear();
+                ha_verify_start_ = uuid::get_uptime() | 1;
+            }
+            queue_subscribe_message(discovery_prefix_ + "/+/" + mqtt_basename_ + "/#");
+            EMSESP::reset_mqtt_ha(); // re-create all HA devices if there are any, unchanged configs are skipped
+        }
+        ha_status(); // create the EMS-ESP device in HA, which is MQTT retained
         ha_climate_reset(true);
     } else {
         // with disabled HA we subscribe and the broker sends all stored HA-emsesp-configs.
@@ -502,6 +672,12 @@ void Mqtt::on_connect() {
         queue_subscribe_message(discovery_prefix_ + "/+/" + mqtt_basename_ + "/#");
     }
 
+    // in delta mode start with all values, so new subscribers don't wait for the next full refresh
+    if (publish_delta()) {
+        EMSESP::mqtt_.last_publish_full_ = uuid::get_uptime();
+        EMSESP::publish_all(true);
+    }
+
     // send initial MQTT messages for some of our services
     EMSESP::shower_.set_shower_state(false, true); // Send shower_activated as false
     EMSESP::system_.send_heartbeat();              // send heartbeat
@@ -582,9 +758,9 @@ void Mqtt::ha_status() {
 
 // add sub or pub task to the queue.
 // the base is not included in the topic
-bool Mqtt::queue_message(const uint8_t operation, const std::string & topic, const std::string & payload, const bool retain) {
+bool Mqtt::queue_message(const uint8_t operation, const std::string & topic, const char * payload, const size_t len, const bool retain) {
     if (topic == "response" && operation == Operation::PUBLISH) {
-        lastresponse_ = payload;
+        lastresponse_.assign(payload, len);
         if (!send_response_) {
             return true;
         }
@@ -593,8 +769,10 @@ bool Mqtt::queue_message(const uint8_t operation, const std::string & topic, con
         return false; // quit, not using MQTT
     }
 // check free mem
+// the outbox copies topic and payload into one block, so refuse only if that block doesn't fit with a reserve left over.
+// small messages still go out when the heap is too fragmented for large ones
 #ifndef EMSESP_STANDALONE
-    if (ESP.getFreeHeap() < 60 * 1204 || ESP.getMaxAllocHeap() < 40 * 1024) {
+    if (ESP.getFreeHeap() < 60 * 1024 || ESP.getMaxAllocHeap() < MQTT_TOPIC_MAX_SIZE + len + MQTT_HEAP_RESERVE) {
         if (operation == Operation::PUBLISH) {
             mqtt_message_id_++;
             mqtt_publish_fails_++;
@@ -623,7 +801,7 @@ bool Mqtt::queue_message(const uint8_t operation, const std::string & topic, con
     }
 
     if (operation == Operation::PUBLISH) {
-        packet_id = mqttClient_->publish(fulltopic, mqtt_qos_, retain, payload.c_str());
+        packet_id = mqttClient_->publish(fulltopic, mqtt_qos_, retain, (const uint8_t *)payload, len);
         mqtt_message_id_++;
         LOG_DEBUG("Publishing topic '%s', pid %d", fulltopic, packet_id);
     } else if (operation == Operation::SUBSCRIBE) {
@@ -642,17 +820,65 @@ bool Mqtt::queue_message(const uint8_t operation, const std::string & topic, con
 
 // add MQTT message to queue, payload is a string
 bool Mqtt::queue_publish_message(const std::string & topic, const std::string & payload, const bool retain) {
-    return queue_message(Operation::PUBLISH, topic, payload, retain);
+    return queue_message(Operation::PUBLISH, topic, payload.c_str(), payload.size(), retain);
+}
+
+// add MQTT message to queue, the json payload is serialized into the publish buffer and the outbox makes the only copy
+// with a config_hash the message is only queued if it differs from the last one (for HA configs, which are retained)
+bool Mqtt::queue_publish_json(const std::string & topic, const JsonObject & payload, const bool retain, uint32_t * config_hash) {
+    std::lock_guard<std::mutex> lock(publish_mutex_);
+
+    const char * payload_text = publish_buffer_;
+    size_t       len          = measureJson(payload);
+    std::string  heap_text; // only for payloads larger than the buffer
+    if (len < sizeof(publish_buffer_)) {
+        serializeJson(payload, publish_buffer_, sizeof(publish_buffer_));
+    } else {
+        publish_buffer_fallbacks_++;
+        heap_text.reserve(len + 1);
+        serializeJson(payload, heap_text);
+        payload_text = heap_text.c_str();
+    }
+
+    uint32_t hash = 0;
+    if (config_hash) {
+        hash = hash_config(topic, payload_text, len);
+        if (*config_hash == hash) {
+            ha_configs_unchanged_++;
+            return true;
+        }
+    }
+
+    if (!queue_message(Operation::PUBLISH, topic, payload_text, len, retain)) {
+        return false;
+    }
+    if (config_hash) {
+        ha_configs_published_++;
+        *config_hash = hash;
+    }
+    return true;
+}
+
+// FNV-1a of topic and payload, never 0 which means not published
+uint32_t Mqtt::hash_config(const std::string & topic, const char * payload, const size_t len) {
+    uint32_t hash = 2166136261UL;
+    for (const char c : topic) {
+        hash = (hash ^ (uint8_t)c) * 16777619UL;
+    }
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ (uint8_t)payload[i]) * 16777619UL;
+    }
+    return hash | 1;
 }
 
 // add MQTT subscribe message to queue
 void Mqtt::queue_subscribe_message(const std::string & topic) {
-    queue_message(Operation::SUBSCRIBE, topic, "", false); // no payload
+    queue_message(Operation::SUBSCRIBE, topic, "", 0, false); // no payload
 }
 
 // add MQTT unsubscribe message to queue
 void Mqtt::queue_unsubscribe_message(const std::string & topic) {
-    queue_message(Operation::UNSUBSCRIBE, topic, "", false); // no payload
+    queue_message(Operation::UNSUBSCRIBE, topic, "", 0, false); // no payload
 }
 
 // MQTT Publish, using a user's retain flag
@@ -691,10 +917,7 @@ bool Mqtt::queue_publish_retain(const std::string & topic, const JsonObject & pa
 
 bool Mqtt::queue_publish_retain(const char * topic, const JsonObject & payload, const bool retain) {
     if (payload.size()) {
-        std::string payload_text;
-        payload_text.reserve(measureJson(payload) + 1);
-        serializeJson(payload, payload_text); // convert json to string
-        return queue_publish_message(topic, payload_text, retain);
+        return queue_publish_json(topic, payload, retain);
     }
     return false;
 }
@@ -708,17 +931,24 @@ bool Mqtt::queue_remove_topic(const char * topic) {
     }
 }
 
-// queue a Home Assistant config topic and payload, with retain flag off.
-bool Mqtt::queue_ha(const char * topic, const JsonObject & payload) {
+// queue a Home Assistant config topic and payload, with retain flag on.
+// with a config_hash the config is only queued if it differs from the last one published, the broker still has that one retained
+bool Mqtt::queue_ha(const char * topic, const JsonObject & payload, uint32_t * config_hash) {
     if (!enabled()) {
         return false;
     }
 
-    std::string payload_text;
-    payload_text.reserve(measureJson(payload) + 1);
-    serializeJson(payload, payload_text); // convert json to string
+    return queue_publish_json(Mqtt::discovery_prefix() + topic, payload, true, config_hash); // with retain true
+}
 
-    return queue_publish_message(Mqtt::discovery_prefix() + topic, payload_text, true); // with retain true
+// pace the discovery configs by free queue space and heap, the rest follow with the next publish
+bool Mqtt::ha_can_queue() {
+#ifndef EMSESP_STANDALONE
+    if (ESP.getMaxAllocHeap() < (6 * 1024) || (!EMSESP::system_.PSram() && ESP.getFreeHeap() < (65 * 1024))) {
+        return false;
+    }
+#endif
+    return mqttClient_->queueSize() < MQTT_HA_QUEUE_LIMIT;
 }
 
 // create's a ha sensor config topic from a device value object
@@ -752,6 +982,11 @@ bool Mqtt::publish_ha_sensor_config(DeviceValue & dv, const char * model, const
     // unless the entity has been marked as read-only and so it'll default to using the sensor/ type
     bool has_cmd = dv.has_cmd && !dv.has_state(DeviceValueState::DV_READONLY);
 
+    // a removed topic has to be published again when the entity comes back
+    if (remove) {
+        dv.ha_config_hash = 0;
+    }
+
     return publish_ha_sensor_config(dv.type,
                                     dv.tag,
                                     dv.get_fullname().c_str(),
@@ -766,7 +1001,8 @@ bool Mqtt::publish_ha_sensor_config(DeviceValue & dv, const char * model, const
                                     dv_set_min,
                                     dv_set_max,
                                     dv.numeric_operator,
-                                    dev_json.as<JsonObject>());
+                                    dev_json.as<JsonObject>(),
+                                    &dv.ha_config_hash);
 }
 
 // publish HA sensor for System using the heartbeat tag
@@ -798,7 +1034,8 @@ bool Mqtt::publish_ha_sensor_config(uint8_t               type,        // EMSdev
                                     const int16_t         dv_set_min,
                                     const uint32_t        dv_set_max,
                                     const int8_t          num_op,
-                                    const JsonObject &    dev_json) {
+                                    const JsonObject &    dev_json,
+                                    uint32_t *            config_hash) {
     // ignore if name (fullname) is empty
     if (!fullname || !en_name) {
         return false;
@@ -1136,7 +1373,7 @@ bool Mqtt::publish_ha_sensor_config(uint8_t               type,        // EMSdev
     // add "availability" section
     add_avty_to_doc(stat_t, doc.as<JsonObject>(), val_cond);
 
-    return queue_ha(topic, doc.as<JsonObject>());
+    return queue_ha(topic, doc.as<JsonObject>(), config_hash);
 }
 
 bool Mqtt::publish_ha_climate_config(const uint8_t tag, const bool has_roomtemp, const bool remove, const int16_t min, const uint32_t max) {
@@ -21,6 +21,8 @@
 
 #include <espMqttClient.h>
 
+#include <mutex>
+
 #include "helpers.h"
 #include "system.h"
 #include "console.h"
@@ -57,6 +59,11 @@ class Mqtt {
 
     static constexpr uint8_t  MQTT_TOPIC_MAX_SIZE = 128; // fixed, not a user setting anymore
     static constexpr uint16_t MQTT_QUEUE_MAX_SIZE = 300;
+    static constexpr uint32_t MQTT_DELTA_REFRESH  = 600000; // full publish of all values every 10 minutes when in delta mode
+    static constexpr uint16_t MQTT_HA_QUEUE_LIMIT = 150;    // discovery configs wait while the queue holds more, leaving room for the data
+    static constexpr uint16_t MQTT_PUBLISH_BUFFER = 4096;   // json payloads are serialized into this, larger ones use the heap
+    static constexpr uint16_t MQTT_HEAP_RESERVE   = 16384;  // heap block that must be left over after the outbox allocates a packet
+    static constexpr uint32_t MQTT_HA_VERIFY_TIME = 10000;  // time after a reconnect to collect the retained discovery configs from the broker
 
     static void on_connect();
     static void on_disconnect(espMqttClientTypes::DisconnectReason reason);
@@ -72,7 +79,8 @@ class Mqtt {
     static bool queue_publish_retain(const std::string & topic, const JsonObject & payload, const bool retain);
     static bool queue_publish_retain(const char * topic, const std::string & payload, const bool retain);
     static bool queue_publish_retain(const char * topic, const JsonObject & payload, const bool retain);
-    static bool queue_ha(const char * topic, const JsonObject & payload);
+    static bool queue_ha(const char * topic, const JsonObject & payload, uint32_t * config_hash = nullptr);
+    static bool ha_can_queue();
     static bool queue_remove_topic(const char * topic);
 
     static bool publish_ha_sensor_config(DeviceValue & dv, const char * model, const char * brand, const bool remove, const bool create_device_config = false);
@@ -90,7 +98,8 @@ class Mqtt {
                                          const int16_t         dv_set_min,
                                          const uint32_t        dv_set_max,
                                          const int8_t          num_op,
-                                         const JsonObject &    dev_json);
+                                         const JsonObject &    dev_json,
+                                         uint32_t *            config_hash = nullptr);
 
     static bool publish_system_ha_sensor_config(uint8_t type, const char * name, const char * entity, const uint8_t uom);
     static bool publish_ha_climate_config(const uint8_t tag, const bool has_roomtemp, const bool remove = false, const int16_t min = 5, const uint32_t max = 30);
@@ -182,10 +191,23 @@ class Mqtt {
         return publish_single2cmd_;
     }
 
+    // identifies the settings a single value topic depends on, never 0
+    static uint8_t topic_format() {
+        return 1 | (publish_single2cmd_ ? 2 : 0) | (is_nested() ? 4 : 0);
+    }
+
     static void publish_single(bool publish_single) {
         publish_single_ = publish_single;
     }
 
+    static bool publish_delta() {
+        return mqtt_enabled_ && publish_delta_ && !ha_enabled_;
+    }
+
+    static void publish_delta(bool publish_delta) {
+        publish_delta_ = publish_delta;
+    }
+
     static bool ha_enabled() {
         return mqtt_enabled_ && ha_enabled_;
     }
@@ -225,13 +247,17 @@ class Mqtt {
     static MqttClient * mqttClient_;
     static uint32_t     mqtt_message_id_;
 
-    static bool queue_message(const uint8_t operation, const std::string & topic, const std::string & payload, const bool retain);
+    static bool queue_message(const uint8_t operation, const std::string & topic, const char * payload, const size_t len, const bool retain);
     static bool queue_publish_message(const std::string & topic, const std::string & payload, const bool retain);
+    static bool queue_publish_json(const std::string & topic, const JsonObject & payload, const bool retain, uint32_t * config_hash = nullptr);
     static void queue_subscribe_message(const std::string & topic);
     static void queue_unsubscribe_message(const std::string & topic);
 
     void on_publish(uint16_t packetId) const;
     void on_message(const char * topic, const uint8_t * payload, size_t len) const;
+    bool route_message(const char * topic, const char * message) const;
+
+    static void command_response(const uint8_t return_code, const JsonObject & output);
 
     // function handlers for MQTT subscriptions
     struct MQTTSubFunction {
@@ -248,6 +274,19 @@ class Mqtt {
 
     static std::vector<MQTTSubFunction> mqtt_subfunctions_; // list of mqtt subscribe callbacks for all devices
 
+    // topic router built from the subscribed topics, one node per topic segment, e.g. boiler -> #
+    static constexpr uint16_t ROUTE_ROOT = 0xFFFF;
+    struct MQTTRoute {
+        std::string segment_;
+        uint16_t    parent_;      // node of the previous segment, ROUTE_ROOT for the first one
+        uint8_t     device_type_; // from the subscription ending here
+        int16_t     subfunction_; // index in mqtt_subfunctions_ of the topic ending here, -1 if none
+    };
+    static std::vector<MQTTRoute> mqtt_routes_;
+
+    static void    add_route(const uint8_t device_type, const std::string & topic, const int16_t subfunction);
+    static int16_t find_route(const uint16_t parent, const char * segment, const size_t len);
+
     // uint32_t last_mqtt_poll_          = 0;
     uint32_t last_publish_boiler_     = 0;
     uint32_t last_publish_thermostat_ = 0;
@@ -256,15 +295,31 @@ class Mqtt {
     uint32_t last_publish_other_      = 0;
     uint32_t last_publish_sensor_     = 0;
     uint32_t last_publish_heartbeat_  = 0;
+    uint32_t last_publish_full_       = 0;
     // uint32_t last_publish_queue_      = 0;
 
     static bool     connecting_;
     static bool     initialized_;
     static uint32_t mqtt_publish_fails_;
+    static uint32_t ha_configs_published_;
+    static uint32_t ha_configs_unchanged_;
+    static uint32_t publish_buffer_fallbacks_;
     static uint16_t queuecount_;
     static uint8_t  connectcount_;
     static bool     ha_climate_reset_;
 
+    static char       publish_buffer_[MQTT_PUBLISH_BUFFER]; // preallocated, so serializing a payload needs no heap
+    static std::mutex publish_mutex_;
+
+    // after a reconnect the broker sends back the retained discovery configs, configs not among them are published again
+    static std::string           ha_broker_;       // host and port of the broker the config hashes were published to
+    static uint32_t              ha_verify_start_; // 0 if not collecting
+    static std::vector<uint32_t> ha_retained_;     // config hashes of the retained configs received
+    static std::mutex            ha_retained_mutex_;
+
+    static uint32_t hash_config(const std::string & topic, const char * payload, const size_t len);
+    static void     ha_verify_done();
+
     static std::string lasttopic_;
     static std::string lastpayload_;
     static std::string lastresponse_;
@@ -290,6 +345,7 @@ class Mqtt {
     static uint8_t     discovery_type_;
     static bool        publish_single_;
     static bool        publish_single2cmd_;
+    static bool        publish_delta_;
     static bool        send_response_;
 };
 
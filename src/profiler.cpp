@@ -0,0 +1,220 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020-2023  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "emsesp.h"
+
+namespace emsesp {
+
+uuid::log::Logger Profiler::logger_{F_(profile), uuid::log::Facility::KERN};
+
+const char * const Profiler::service_names_[NUM_SERVICES] =
+    {"loop", "web", "system", "weblog", "rx", "shower", "temperaturesensor", "analogsensor", "publish", "mqtt", "scheduler", "fetch", "console"};
+
+// bucket 0 is 0us, 1 is 1us, then two buckets per power of 2: [2^n, 1.5*2^n) and [1.5*2^n, 2^(n+1))
+static uint8_t bucket(const uint32_t us) {
+    if (us < 2) {
+        return us;
+    }
+    uint8_t n = 31 - __builtin_clz(us);
+    uint8_t i = 2 * n + ((us >> (n - 1)) & 1);
+    return i < Profiler::NUM_BUCKETS ? i : Profiler::NUM_BUCKETS - 1;
+}
+
+// lowest value of a bucket
+static uint32_t bucket_limit(const uint8_t i) {
+    if (i < 2) {
+        return i;
+    }
+    return ((uint32_t)1 << (i / 2)) + (i & 1) * ((uint32_t)1 << (i / 2 - 1));
+}
+
+void Profiler::Timing::add(const uint32_t us) {
+    uint8_t i = bucket(us);
+    if (count_[i] == UINT16_MAX) {
+        for (auto & c : count_) {
+            c /= 2;
+        }
+    }
+    count_[i]++;
+    if (!total_ || us < min_) {
+        min_ = us;
+    }
+    if (us > max_) {
+        max_ = us;
+    }
+    total_++;
+    sum_ += us;
+}
+
+// the upper limit of the bucket holding the 99th percentile, or the max if that is lower
+uint32_t Profiler::Timing::p99() const {
+    uint32_t total = 0;
+    for (const auto & c : count_) {
+        total += c;
+    }
+    uint32_t target = total - total / 100;
+    uint32_t sum    = 0;
+    for (uint8_t i = 0; i < NUM_BUCKETS - 1; i++) {
+        sum += count_[i];
+        if (sum >= target) {
+            return std::min(bucket_limit(i + 1) - 1, max_);
+        }
+    }
+    return max_;
+}
+
+void Profiler::Timing::output(JsonObject & json) const {
+    json["count"]  = total_;
+    json["min"]    = min_;
+    json["avg"]    = avg();
+    json["p99"]    = p99();
+    json["max"]    = max_;
+    json["stalls"] = stalls_;
+}
+
+// count a slice over the threshold, returns true if it should be logged
+bool Profiler::stall(Timing & timing, const uint32_t us) {
+    if (us < stall_threshold_) {
+        return false;
+    }
+    timing.stalls_++;
+    return true;
+}
+
+// limit the logging, so a slow service does not flood the log
+bool Profiler::log_stall() {
+    uint32_t now = millis();
+    if (last_stall_log_ && now - last_stall_log_ < STALL_LOG_DELAY) {
+        return false;
+    }
+    last_stall_log_ = now ? now : 1;
+    return true;
+}
+
+uint32_t Profiler::lap(const Service service, const uint32_t start) {
+    uint32_t now = micros();
+    uint32_t us  = now - start;
+    services_[service].add(us);
+    if (stall(services_[service], us)) {
+        // a stalled loop is only logged when none of its services was
+        if ((service != LOOP || !stalled_) && log_stall()) {
+            LOG_WARNING("Loop stall: %s took %lu ms", service_names_[service], (unsigned long)us / 1000);
+        }
+        stalled_ = (service != LOOP);
+    } else if (service == LOOP) {
+        stalled_ = false;
+    }
+    return now;
+}
+
+// time of a telegram handler of a device
+void Profiler::add_device(const uint8_t device_id, const uint32_t start) {
+    uint32_t us = micros() - start;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    DeviceTiming *              device = nullptr;
+    for (auto & d : devices_) {
+        if (d.device_id_ == device_id) {
+            device = &d;
+            break;
+        }
+    }
+    if (device == nullptr) {
+        devices_.emplace_back();
+        device             = &devices_.back();
+        device->device_id_ = device_id;
+    }
+    device->timing_.add(us);
+    if (stall(device->timing_, us)) {
+        if (log_stall()) {
+            LOG_WARNING("Loop stall: telegram handler of device 0x%02X took %lu ms", device_id, (unsigned long)us / 1000);
+        }
+        stalled_ = true;
+    }
+}
+
+void Profiler::reset() {
+    for (auto & s : services_) {
+        s = Timing();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    devices_.clear();
+}
+
+// name of the device like in pretty_telegram(), or its hex id
+static std::string device_name(const uint8_t device_id) {
+    char name[30];
+    snprintf(name, sizeof(name), "0x%02X", device_id);
+    for (const auto & emsdevice : EMSESP::emsdevices) {
+        if (emsdevice && emsdevice->is_device_id(device_id)) {
+            snprintf(name, sizeof(name), "%s(0x%02X)", emsdevice->device_type_name(), device_id);
+            break;
+        }
+    }
+    return name;
+}
+
+static void show_timing(uuid::console::Shell & shell, const char * name, const Profiler::Timing & t) {
+    if (!t.total_) {
+        return;
+    }
+    shell.printfln("  %-20s %9lu %7lu %7lu %7lu %7lu %6lu",
+                   name,
+                   (unsigned long)t.total_,
+                   (unsigned long)t.min_,
+                   (unsigned long)t.avg(),
+                   (unsigned long)t.p99(),
+                   (unsigned long)t.max_,
+                   (unsigned long)t.stalls_);
+}
+
+void Profiler::show(uuid::console::Shell & shell) const {
+    shell.printfln("Loop timing (us), stall threshold %lu ms:", (unsigned long)stall_threshold_ / 1000);
+    shell.printfln("  %-20s %9s %7s %7s %7s %7s %6s", "", "count", "min", "avg", "p99", "max", "stalls");
+    for (uint8_t i = 0; i < NUM_SERVICES; i++) {
+        show_timing(shell, service_names_[i], services_[i]);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!devices_.empty()) {
+        shell.printfln("Telegram handler timing (us):");
+        for (const auto & d : devices_) {
+            show_timing(shell, device_name(d.device_id_).c_str(), d.timing_);
+        }
+    }
+    shell.println();
+}
+
+// all timings as json, for the system profile command
+void Profiler::output(JsonObject & json) const {
+    json["stall threshold"] = stall_threshold_ / 1000; // ms
+    JsonObject services     = json.createNestedObject("services");
+    for (uint8_t i = 0; i < NUM_SERVICES; i++) {
+        JsonObject service = services.createNestedObject(service_names_[i]);
+        services_[i].output(service);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    JsonObject                  handlers = json.createNestedObject("telegram handlers");
+    for (const auto & d : devices_) {
+        JsonObject device = handlers.createNestedObject(device_name(d.device_id_));
+        d.timing_.output(device);
+    }
+}
+
+} // namespace emsesp
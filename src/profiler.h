@@ -0,0 +1,101 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020-2023  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMSESP_PROFILER_H
+#define EMSESP_PROFILER_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#include <mutex>
+#include <vector>
+
+#include <uuid/console.h>
+#include <uuid/log.h>
+
+namespace emsesp {
+
+// time spent in each service of the main loop and in the telegram handlers of each device, in microseconds
+// a slice taking longer than the stall threshold is logged, as it can make the Rx queue overflow
+class Profiler {
+  public:
+    // the services called from EMSESP::loop(), LOOP is the whole loop
+    enum Service : uint8_t { LOOP, WEB, SYSTEM, WEBLOG, RX, SHOWER, TEMPERATURESENSOR, ANALOGSENSOR, PUBLISH, MQTT, SCHEDULER, FETCH, CONSOLE, NUM_SERVICES };
+
+    static constexpr uint8_t  NUM_BUCKETS     = 40;    // two per power of 2, the last one is open
+    static constexpr uint32_t STALL_THRESHOLD = 50000; // us
+    static constexpr uint32_t STALL_LOG_DELAY = 1000;  // ms between stall logs, stalls are still counted
+
+    struct Timing {
+        uint16_t count_[NUM_BUCKETS] = {}; // halved when one is full, so old samples fade out
+        uint32_t total_              = 0;
+        uint64_t sum_                = 0;
+        uint32_t min_                = 0;
+        uint32_t max_                = 0;
+        uint32_t stalls_             = 0;
+
+        void     add(const uint32_t us);
+        uint32_t p99() const;
+        uint32_t avg() const {
+            return total_ ? sum_ / total_ : 0;
+        }
+        void output(JsonObject & json) const;
+    };
+
+    // records the time since start for the service and returns the current time, for the next service
+    uint32_t lap(const Service service, const uint32_t start);
+    void     add_device(const uint8_t device_id, const uint32_t start);
+
+    const Timing & loop_timing() const {
+        return services_[LOOP];
+    }
+    uint32_t stall_threshold() const {
+        return stall_threshold_;
+    }
+    void set_stall_threshold(const uint32_t us) {
+        stall_threshold_ = us;
+    }
+
+    void reset();
+    void show(uuid::console::Shell & shell) const;
+    void output(JsonObject & json) const;
+
+  private:
+    struct DeviceTiming {
+        uint8_t device_id_;
+        Timing  timing_;
+    };
+
+    static uuid::log::Logger logger_;
+
+    static const char * const service_names_[NUM_SERVICES];
+
+    bool stall(Timing & timing, const uint32_t us);
+    bool log_stall();
+
+    Timing                    services_[NUM_SERVICES];
+    std::vector<DeviceTiming> devices_;                            // one for each device with a telegram handler called
+    uint32_t                  stall_threshold_ = STALL_THRESHOLD; // us
+    bool                      stalled_         = false;           // a stall was found in this loop
+    uint32_t                  last_stall_log_  = 0;
+    mutable std::mutex        mutex_;                             // the device list grows in the main loop and is read from web requests
+};
+
+} // namespace emsesp
+
+#endif
@@ -82,15 +82,17 @@ bool     System::test_set_all_active_ = false;
 uint32_t System::max_alloc_mem_;
 uint32_t System::heap_mem_;
 
-// find the index of the language
+// set the locale and find the index of its language
 // 0 = EN, 1 = DE, etc...
-uint8_t System::language_index() {
+void System::locale(String locale) {
+    locale_         = locale;
+    language_index_ = 0; // EN
     for (uint8_t i = 0; i < NUM_LANGUAGES; i++) {
-        if (languages[i] == locale()) {
-            return i;
+        if (locale_ == languages[i]) {
+            language_index_ = i;
+            break;
         }
     }
-    return 0; // EN
 }
 
 // send raw to ems
@@ -142,7 +144,8 @@ bool System::command_publish(const char * value, const int8_t id) {
     std::string value_s;
     if (Helpers::value2string(value, value_s)) {
         if (value_s == "ha") {
-            EMSESP::publish_all(true); // includes HA
+            EMSESP::reset_mqtt_ha(true); // also the unchanged HA configs
+            EMSESP::publish_all(true);   // includes HA
             LOG_INFO("Publishing all data to MQTT, including HA configs");
             return true;
         } else if (value_s == (F_(boiler))) {
@@ -167,7 +170,7 @@ bool System::command_publish(const char * value, const int8_t id) {
     }
 
     LOG_INFO("Publishing all data to MQTT");
-    EMSESP::publish_all();
+    EMSESP::publish_all(true); // all values, also in delta mode
 
     return true;
 }
@@ -231,6 +234,37 @@ bool System::command_watch(const char * value, const int8_t id) {
     return false;
 }
 
+// bus capture, save to the filesystem (default) or clear
+bool System::command_capture(const char * value, const int8_t id) {
+    std::string value_s;
+    if (Helpers::value2string(value, value_s) && value_s == "clear") {
+        LOG_INFO("Clearing bus capture");
+        EMSESP::buscapture_.clear();
+        return true;
+    }
+    return EMSESP::buscapture_.save();
+}
+
+// Tx latency histograms, retries and bus occupancy, also for MQTT on request
+bool System::command_busstats(const char * value, const int8_t id, JsonObject & output) {
+    EMSESP::busstats_.output(output);
+    return true;
+}
+
+// loop timing per service and telegram handler, "reset" clears it and a number sets the stall threshold in ms
+bool System::command_profile(const char * value, const int8_t id, JsonObject & output) {
+    std::string value_s;
+    int         threshold;
+    if (Helpers::value2string(value, value_s) && value_s == "reset") {
+        LOG_INFO("Resetting loop timing");
+        EMSESP::profiler_.reset();
+    } else if (Helpers::value2number(value, threshold, 1, 10000)) {
+        EMSESP::profiler_.set_stall_threshold(threshold * 1000);
+    }
+    EMSESP::profiler_.output(output);
+    return true;
+}
+
 void System::store_nvs_values() {
     Command::call(EMSdevice::DeviceType::BOILER, "nompower", "-1"); // trigger a write
     EMSESP::analogsensor_.store_counters();
@@ -276,8 +310,8 @@ void System::syslog_init() {
         syslog_mark_interval_ = settings.syslog_mark_interval;
         syslog_host_          = settings.syslog_host;
         syslog_port_          = settings.syslog_port;
+        syslog_tcp_           = settings.syslog_tcp;
     });
-#ifndef EMSESP_STANDALONE
     if (syslog_enabled_) {
         // start & configure syslog
         EMSESP::logger().info("Starting Syslog service");
@@ -285,6 +319,7 @@ void System::syslog_init() {
 
         syslog_.log_level((uuid::log::Level)syslog_level_);
         syslog_.mark_interval(syslog_mark_interval_);
+        syslog_.tcp(syslog_tcp_);
         syslog_.destination(syslog_host_.c_str(), syslog_port_);
         syslog_.hostname(hostname().c_str());
 
@@ -299,6 +334,7 @@ void System::syslog_init() {
         syslog_.mark_interval(0);
         syslog_.destination("");
     }
+#ifndef EMSESP_STANDALONE
     if (Mqtt::publish_single()) {
         if (Mqtt::publish_single2cmd()) {
             Mqtt::queue_publish("system/syslog", syslog_enabled_ ? (FL_(list_syslog_level)[syslog_level_ + 1]) : "off");
@@ -344,6 +380,7 @@ void System::reload_settings() {
         syslog_mark_interval_ = settings.syslog_mark_interval;
         syslog_host_          = settings.syslog_host;
         syslog_port_          = settings.syslog_port;
+        syslog_tcp_           = settings.syslog_tcp;
 
         fahrenheit_     = settings.fahrenheit;
         bool_format_    = settings.bool_format;
@@ -356,7 +393,7 @@ void System::reload_settings() {
         eth_phy_addr_   = settings.eth_phy_addr;
         eth_clock_mode_ = settings.eth_clock_mode;
 
-        locale_ = settings.locale;
+        locale(settings.locale);
     });
 }
 
@@ -540,13 +577,13 @@ void System::loop() {
         this->system_restart();
     }
 
-#ifndef EMSESP_STANDALONE
-    myPButton_.check(); // check button press
-
     if (syslog_enabled_) {
         syslog_.loop();
     }
 
+#ifndef EMSESP_STANDALONE
+    myPButton_.check(); // check button press
+
     led_monitor();  // check status and report back using the LED
     system_check(); // check system health
 #endif
@@ -764,6 +801,7 @@ void System::commands_init() {
     // restart and watch (and test) are also exposed as Console commands
     Command::add(EMSdevice::DeviceType::SYSTEM, F_(restart), System::command_restart, FL_(restart_cmd), CommandFlag::ADMIN_ONLY);
     Command::add(EMSdevice::DeviceType::SYSTEM, F_(watch), System::command_watch, FL_(watch_cmd));
+    Command::add(EMSdevice::DeviceType::SYSTEM, F_(capture), System::command_capture, FL_(capture_cmd), CommandFlag::ADMIN_ONLY);
 #if defined(EMSESP_TEST)
     Command::add(EMSdevice::DeviceType::SYSTEM, ("test"), System::command_test, FL_(test_cmd));
 #endif
@@ -772,6 +810,8 @@ void System::commands_init() {
     Command::add(EMSdevice::DeviceType::SYSTEM, F_(info), System::command_info, FL_(system_info_cmd));
     Command::add(EMSdevice::DeviceType::SYSTEM, F_(commands), System::command_commands, FL_(commands_cmd));
     Command::add(EMSdevice::DeviceType::SYSTEM, F("response"), System::command_response, FL_(commands_response));
+    Command::add(EMSdevice::DeviceType::SYSTEM, F_(busstats), System::command_busstats, FL_(busstats_cmd));
+    Command::add(EMSdevice::DeviceType::SYSTEM, F_(profile), System::command_profile, FL_(profile_cmd), CommandFlag::ADMIN_ONLY);
 
     // MQTT subscribe "ems-esp/system/#"
     Mqtt::subscribe(EMSdevice::DeviceType::SYSTEM, "system/#", nullptr); // use empty function callback
@@ -996,11 +1036,12 @@ void System::show_system(uuid::console::Shell & shell) {
         shell.printfln(" IP: %s", uuid::printable_to_string(syslog_.ip()).c_str());
         shell.print(" ");
         shell.printfln(F_(port_fmt), syslog_port_);
+        shell.printfln(" Protocol: %s", syslog_tcp_ ? "TCP" : "UDP");
         shell.print(" ");
         shell.printfln(F_(log_level_fmt), uuid::log::format_level_lowercase(static_cast<uuid::log::Level>(syslog_level_)));
         shell.print(" ");
         shell.printfln(F_(mark_interval_fmt), syslog_mark_interval_);
-        shell.printfln(" Queued: %d", syslog_.queued());
+        shell.printfln(" Queued: %d (%d bytes)", syslog_.queued(), syslog_.queued_bytes());
     }
 
 #endif
@@ -1183,6 +1224,10 @@ bool System::command_info(const char * value, const int8_t id, JsonObject & outp
     node["free app"]  = EMSESP::system_.appFree(); // kilobytes
 #endif
     node["reset reason"] = EMSESP::system_.reset_reason(0) + " / " + EMSESP::system_.reset_reason(1);
+    node["loop time avg (us)"] = EMSESP::profiler_.loop_timing().avg();
+    node["loop time p99 (us)"] = EMSESP::profiler_.loop_timing().p99();
+    node["loop time max (us)"] = EMSESP::profiler_.loop_timing().max_;
+    node["loop stalls"]        = EMSESP::profiler_.loop_timing().stalls_;
 
 #ifndef EMSESP_STANDALONE
     // Network Status
@@ -1280,6 +1325,7 @@ bool System::command_info(const char * value, const int8_t id, JsonObject & outp
         node["publish time sensor"]     = settings.publish_time_sensor;
         node["publish single"]          = settings.publish_single;
         node["publish2command"]         = settings.publish_single2cmd;
+        node["publish delta"]           = settings.publish_delta;
         node["send response"]           = settings.send_response;
     });
 
@@ -1288,24 +1334,31 @@ bool System::command_info(const char * value, const int8_t id, JsonObject & outp
     node["enabled"] = EMSESP::system_.syslog_enabled_;
 #ifndef EMSESP_STANDALONE
     if (EMSESP::system_.syslog_enabled_) {
-        node["syslog started"] = syslog_.started();
-        node["syslog level"]   = FL_(list_syslog_level)[syslog_.log_level() + 1];
-        node["syslog ip"]      = syslog_.ip();
-        node["syslog queue"]   = syslog_.queued();
+        node["syslog started"]     = syslog_.started();
+        node["syslog level"]       = FL_(list_syslog_level)[syslog_.log_level() + 1];
+        node["syslog ip"]          = syslog_.ip();
+        node["syslog protocol"]    = syslog_.tcp() ? "TCP" : "UDP";
+        node["syslog queue"]       = syslog_.queued();
+        node["syslog queue bytes"] = syslog_.queued_bytes();
     }
 #endif
 
     // Sensor Status
     node = output.createNestedObject("Sensor Info");
     if (EMSESP::sensor_enabled()) {
-        node["temperature sensors"]      = EMSESP::temperaturesensor_.no_sensors();
-        node["temperature sensor reads"] = EMSESP::temperaturesensor_.reads();
-        node["temperature sensor fails"] = EMSESP::temperaturesensor_.fails();
+        node["temperature sensors"]              = EMSESP::temperaturesensor_.no_sensors();
+        node["temperature sensor reads"]         = EMSESP::temperaturesensor_.reads();
+        node["temperature sensor fails"]         = EMSESP::temperaturesensor_.fails();
+        node["temperature sensor crc fails"]     = EMSESP::temperaturesensor_.crc_fails();
+        node["temperature sensor retries"]       = EMSESP::temperaturesensor_.retries();
+        node["temperature sensor max loop (us)"] = EMSESP::temperaturesensor_.max_loop_time();
     }
     if (EMSESP::analog_enabled()) {
-        node["analog sensors"]      = EMSESP::analogsensor_.no_sensors();
-        node["analog sensor reads"] = EMSESP::analogsensor_.reads();
-        node["analog sensor fails"] = EMSESP::analogsensor_.fails();
+        node["analog sensors"]              = EMSESP::analogsensor_.no_sensors();
+        node["analog sensor reads"]         = EMSESP::analogsensor_.reads();
+        node["analog sensor fails"]         = EMSESP::analogsensor_.fails();
+        node["analog sensor edges"]         = EMSESP::analogsensor_.edges();
+        node["analog sensor edges dropped"] = EMSESP::analogsensor_.edges_dropped();
     }
 
     // API Status
@@ -1334,11 +1387,23 @@ bool System::command_info(const char * value, const int8_t id, JsonObject & outp
         node["bus telegrams received (rx)"] = EMSESP::rxservice_.telegram_count();
         node["bus reads (tx)"]              = EMSESP::txservice_.telegram_read_count();
         node["bus writes (tx)"]             = EMSESP::txservice_.telegram_write_count();
+        node["bus reads merged (tx)"]       = EMSESP::txservice_.telegram_merged_count();
+        node["bus reads skipped (tx)"]      = EMSESP::fetch_skipped();
         node["bus incomplete telegrams"]    = EMSESP::rxservice_.telegram_error_count();
+        node["bus rx dropped telegrams"]    = EMSESP::rxservice_.telegram_overflow_count();
+        node["bus rx queue max"]            = EMSESP::rxservice_.queue_max();
+        node["bus telegram pool max"]       = TelegramPool::high_water();
+        node["bus telegram pool fallbacks"] = TelegramPool::fallback_count();
         node["bus reads failed"]            = EMSESP::txservice_.telegram_read_fail_count();
         node["bus writes failed"]           = EMSESP::txservice_.telegram_write_fail_count();
         node["bus rx line quality"]         = EMSESP::rxservice_.quality();
         node["bus tx line quality"]         = (EMSESP::txservice_.read_quality() + EMSESP::txservice_.read_quality()) / 2;
+        node["bus dispatch hits"]           = EMSESP::telegram_dispatch_hits();
+        node["bus dispatch misses"]         = EMSESP::telegram_dispatch_misses();
+        node["bus occupancy"]               = EMSESP::busstats_.occupancy();
+        node["bus tx queue wait"]           = EMSESP::busstats_.queue_wait().avg();
+        node["bus tx read latency"]         = EMSESP::busstats_.read_latency();
+        node["bus tx write latency"]        = EMSESP::busstats_.write_latency();
     }
 
     // Settings
@@ -1372,6 +1437,7 @@ bool System::command_info(const char * value, const int8_t id, JsonObject & outp
         node["readonly mode"]      = settings.readonly_mode;
         node["fahrenheit"]         = settings.fahrenheit;
         node["dallas parasite"]    = settings.dallas_parasite;
+        node["dallas budget"]      = settings.dallas_budget;
         node["bool format"]        = settings.bool_format;
         node["bool dashboard"]     = settings.bool_dashboard;
         node["enum format"]        = settings.enum_format;
@@ -33,10 +33,10 @@
 // #include <esp_bt.h>
 #endif
 #include <ETH.h>
-#include <uuid/syslog.h>
 #endif
 
 #include <uuid/log.h>
+#include <uuid/syslog.h>
 #include <PButton.h>
 
 using uuid::console::Shell;
@@ -57,6 +57,9 @@ class System {
     static bool command_restart(const char * value, const int8_t id);
     static bool command_syslog_level(const char * value, const int8_t id);
     static bool command_watch(const char * value, const int8_t id);
+    static bool command_capture(const char * value, const int8_t id);
+    static bool command_busstats(const char * value, const int8_t id, JsonObject & output);
+    static bool command_profile(const char * value, const int8_t id, JsonObject & output);
     static bool command_info(const char * value, const int8_t id, JsonObject & output);
     static bool command_commands(const char * value, const int8_t id, JsonObject & output);
     static bool command_response(const char * value, const int8_t id, JsonObject & output);
@@ -85,7 +88,6 @@ class System {
         return syslog_enabled_;
     }
 
-#ifndef EMSESP_STANDALONE
     unsigned long syslog_count() {
         return syslog_.message_count();
     }
@@ -93,7 +95,6 @@ class System {
     unsigned long syslog_fails() {
         return syslog_.message_fails();
     }
-#endif
 
     void led_init(bool refresh);
     void network_init(bool refresh);
@@ -200,12 +201,13 @@ class System {
         return fahrenheit_;
     }
 
-    uint8_t language_index();
-
-    void locale(String locale) {
-        locale_ = locale;
+    // resolved when the locale is set, so translating is an array index
+    uint8_t language_index() const {
+        return language_index_;
     }
 
+    void locale(String locale);
+
     std::string locale() {
         return std::string(locale_.c_str());
     }
@@ -283,9 +285,7 @@ class System {
     static constexpr uint8_t  HEALTHCHECK_NO_NETWORK          = (1 << 1); // 2
     static constexpr uint8_t  LED_ON                          = HIGH;     // LED on
 
-#ifndef EMSESP_STANDALONE
     static uuid::syslog::SyslogService syslog_;
-#endif
 
     void led_monitor();
     void system_check();
@@ -307,6 +307,7 @@ class System {
     // copies from WebSettings class in WebSettingsService.h and loaded with reload_settings()
     std::string hostname_;
     String      locale_;
+    uint8_t     language_index_ = 0;
     bool        hide_led_;
     uint8_t     led_gpio_;
     bool        analog_enabled_;
@@ -322,6 +323,7 @@ class System {
     uint32_t    syslog_mark_interval_;
     String      syslog_host_;
     uint16_t    syslog_port_;
+    bool        syslog_tcp_;
     bool        fahrenheit_;
     uint8_t     bool_dashboard_;
     uint8_t     bool_format_;
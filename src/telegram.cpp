@@ -46,6 +46,55 @@ uint8_t  EMSbus::tx_state_          = Telegram::Operation::NONE;
 
 uuid::log::Logger EMSbus::logger_{F_(telegram), uuid::log::Facility::CONSOLE};
 
+TelegramPool::Block   TelegramPool::blocks_[TelegramPool::POOL_SIZE];
+TelegramPool::Block * TelegramPool::free_list_      = nullptr;
+bool                  TelegramPool::initialized_    = false;
+uint8_t               TelegramPool::in_use_         = 0;
+uint8_t               TelegramPool::high_water_     = 0;
+uint32_t              TelegramPool::fallback_count_ = 0;
+std::mutex            TelegramPool::mutex_;
+
+// take a block from the pool, or from the heap if the pool is empty or the size doesn't fit
+void * TelegramPool::allocate(const size_t size) {
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    // build the free list on first use
+    if (!initialized_) {
+        for (uint8_t i = 0; i < POOL_SIZE; i++) {
+            blocks_[i].next_ = (i + 1 < POOL_SIZE) ? &blocks_[i + 1] : nullptr;
+        }
+        free_list_   = &blocks_[0];
+        initialized_ = true;
+    }
+
+    if (size > BLOCK_SIZE || free_list_ == nullptr) {
+        fallback_count_++;
+        return ::operator new(size);
+    }
+
+    Block * block = free_list_;
+    free_list_    = block->next_;
+    if (++in_use_ > high_water_) {
+        high_water_ = in_use_;
+    }
+    return block;
+}
+
+// return a block to the pool, or to the heap if it didn't come from the pool
+void TelegramPool::deallocate(void * p) {
+    auto addr = reinterpret_cast<uintptr_t>(p);
+    if (addr < reinterpret_cast<uintptr_t>(&blocks_[0]) || addr > reinterpret_cast<uintptr_t>(&blocks_[POOL_SIZE - 1])) {
+        ::operator delete(p);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock{mutex_};
+    Block * block = static_cast<Block *>(p);
+    block->next_  = free_list_;
+    free_list_    = block;
+    in_use_--;
+}
+
 // Calculates CRC checksum using lookup table for speed
 // length excludes the last byte (which mainly is the CRC)
 uint8_t EMSbus::calculate_crc(const uint8_t * data, const uint8_t length) {
@@ -126,25 +175,88 @@ std::string Telegram::to_string_message() const {
     return Helpers::data_to_hex(this->message_data, this->message_length);
 }
 
-// checks if we have an Rx telegram that needs processing
+// checks if we have Rx frames that need processing
 void RxService::loop() {
-    while (!rx_telegrams_.empty()) {
-        auto telegram = rx_telegrams_.front().telegram_;
-        (void)EMSESP::process_telegram(telegram); // further process the telegram
-        increment_telegram_count();               // increase rx count
-        rx_telegrams_.pop_front();                // remove it from the queue
+    uint8_t tail = rx_tail_.load(std::memory_order_relaxed);
+    while (tail != rx_head_.load(std::memory_order_acquire)) {
+        process_frame(rx_frames_[tail].data_, rx_frames_[tail].length_);
+        tail = (tail + 1) % RX_RING_SIZE;
+        rx_tail_.store(tail, std::memory_order_release); // hand the slot back to add()
     }
 }
 
-// add a new rx telegram object
+// add a new rx frame to the queue, called from the UART task
 // data is the whole telegram, assuming last byte holds the CRC
 // length includes the CRC
-// for EMS+ the type_id has the value + 256. We look for these type of telegrams with F7, F9 and FF in 3rd byte
+// the frame is recorded in the bus capture first, so frames dropped below are in the capture too
 void RxService::add(uint8_t * data, uint8_t length) {
     if (length < 5) {
         return;
     }
 
+    EMSESP::buscapture_.record(data, length, data[length - 1] == calculate_crc(data, length - 1));
+    queue_frame(data, length);
+}
+
+// copy a frame into the queue, it's validated and decoded in loop(). If the queue is full or the frame too long it is dropped and counted
+void RxService::queue_frame(const uint8_t * data, const uint8_t length) {
+    uint8_t head = rx_head_.load(std::memory_order_relaxed);
+    uint8_t next = (head + 1) % RX_RING_SIZE;
+    uint8_t tail = rx_tail_.load(std::memory_order_acquire);
+    if (length > EMS_MAX_TELEGRAM_LENGTH) {
+        telegram_oversize_count_++; // a malformed frame, counted as an Rx error
+        return;
+    }
+    if (next == tail) {
+        telegram_overflow_count_++;
+        return;
+    }
+
+    auto & frame   = rx_frames_[head];
+    frame.id_      = rx_telegram_id_++;
+    frame.length_  = length;
+    memcpy(frame.data_, data, length);
+    rx_head_.store(next, std::memory_order_release); // publish the frame to loop()
+
+    uint8_t size = (next + RX_RING_SIZE - tail) % RX_RING_SIZE;
+    if (size > queue_max_) {
+        queue_max_ = size;
+    }
+}
+
+// add an empty telegram to the queue, used to signal a failed read
+// it is built as a raw frame with CRC so it takes the same path as a received telegram, but is not recorded in the bus capture
+void RxService::add_empty(const uint8_t src, const uint8_t dest, const uint16_t type_id, uint8_t offset) {
+    uint8_t data[7];
+    uint8_t length = 0;
+    data[length++] = src;
+    data[length++] = dest;
+    if (type_id > 0xFF) {
+        data[length++] = 0xFF;
+        data[length++] = offset;
+        data[length++] = (type_id - 256) >> 8;
+        data[length++] = (type_id - 256) & 0xFF;
+    } else {
+        data[length++] = type_id;
+        data[length++] = offset;
+    }
+    data[length] = calculate_crc(data, length);
+    queue_frame(data, length + 1);
+}
+
+// returns a copy of the frames waiting in the queue
+std::vector<RxService::QueuedRxFrame> RxService::queue() const {
+    std::vector<QueuedRxFrame> frames;
+    uint8_t                    head = rx_head_.load(std::memory_order_acquire);
+    for (uint8_t i = rx_tail_.load(std::memory_order_relaxed); i != head; i = (i + 1) % RX_RING_SIZE) {
+        frames.push_back(rx_frames_[i]);
+    }
+    return frames;
+}
+
+// validate and decode a rx frame and process it
+// for EMS+ the type_id has the value + 256. We look for these type of telegrams with F7, F9 and FF in 3rd byte
+void RxService::process_frame(const uint8_t * data, const uint8_t length) {
     // validate the CRC. if it fails then increment the number of corrupt/incomplete telegrams and only report to console/syslog
     uint8_t crc = calculate_crc(data, length - 1);
     if (data[length - 1] != crc) {
@@ -171,9 +283,9 @@ void RxService::add(uint8_t * data, uint8_t length) {
     uint8_t offset    = data[3];        // offset is always 4th byte
     uint8_t operation = (data[1] & 0x80) ? Telegram::Operation::RX_READ : Telegram::Operation::RX;
 
-    uint16_t  type_id;
-    uint8_t * message_data;   // where the message block starts
-    uint8_t   message_length; // length of the message block, excluding CRC
+    uint16_t        type_id;
+    const uint8_t * message_data;   // where the message block starts
+    uint8_t         message_length; // length of the message block, excluding CRC
 
     // work out depending on the type, where the data message block starts and the message length
     // EMS 1 has type_id always in data[2], if it gets a ems+ inquiry it will reply with FF but short length
@@ -219,24 +331,10 @@ void RxService::add(uint8_t * data, uint8_t length) {
         return;
     }
 
-    // create the telegram
-    auto telegram = std::make_shared<Telegram>(operation, src, dest, type_id, offset, message_data, message_length);
-
-    // check if queue is full, if so remove top item to make space
-    if (rx_telegrams_.size() >= MAX_RX_TELEGRAMS) {
-        rx_telegrams_.pop_front();
-    }
-
-    rx_telegrams_.emplace_back(rx_telegram_id_++, std::move(telegram)); // add to queue
-}
-
-// add empty telegram to rx-queue
-void RxService::add_empty(const uint8_t src, const uint8_t dest, const uint16_t type_id, uint8_t offset) {
-    auto telegram = std::make_shared<Telegram>(Telegram::Operation::RX, src, dest, type_id, offset, nullptr, 0);
-    // only if queue is  not full
-    if (rx_telegrams_.size() < MAX_RX_TELEGRAMS) {
-        rx_telegrams_.emplace_back(rx_telegram_id_++, std::move(telegram)); // add to queue
-    }
+    // create the telegram and process it
+    auto telegram = make_telegram(operation, src, dest, type_id, offset, message_data, message_length);
+    (void)EMSESP::process_telegram(telegram); // further process the telegram
+    increment_telegram_count();               // increase rx count
 }
 
 // start and initialize Tx
@@ -268,7 +366,8 @@ void TxService::send_poll() const {
 
 // get src id from next telegram to check poll in emsesp::incoming_telegram
 uint8_t TxService::get_send_id() {
-    static uint32_t count = 0;
+    static uint32_t                       count = 0;
+    std::lock_guard<std::recursive_mutex> lock(tx_mutex_);
     if (!tx_telegrams_.empty() && tx_telegrams_.front().telegram_->src != ems_bus_id()) {
         if (++count > 500) { // after 500 polls (~3-10 sec) there will be no master poll for this id
             tx_telegrams_.pop_front();
@@ -289,6 +388,8 @@ void TxService::send() {
         return;
     }
 
+    std::lock_guard<std::recursive_mutex> lock(tx_mutex_);
+
     // if there's nothing in the queue to transmit or sending should be delayed, send back a poll and quit
     if (tx_telegrams_.empty() || (delayed_send_ && uuid::get_uptime() < delayed_send_)) {
         send_poll();
@@ -367,7 +468,7 @@ void TxService::send_telegram(const QueuedTxTelegram & tx_telegram) {
         }
     }
     // make a copy of the telegram with new dest (without read-flag)
-    telegram_last_ = std::make_shared<Telegram>(
+    telegram_last_ = make_telegram(
         telegram->operation, telegram->src, dest & 0x7F, telegram->type_id, telegram->offset, telegram->message_data, telegram->message_length);
 
     uint8_t length       = message_p;
@@ -404,6 +505,7 @@ void TxService::send_telegram(const QueuedTxTelegram & tx_telegram) {
         return;
     }
 
+    EMSESP::busstats_.tx_sent(telegram->operation, dest, millis() - tx_telegram.queued_time_);
     tx_state(telegram->operation); // tx now in a wait state
 }
 
@@ -439,28 +541,108 @@ void TxService::add(const uint8_t  operation,
                     const uint8_t  message_length,
                     const uint16_t validateid,
                     const bool     front) {
-    auto telegram = std::make_shared<Telegram>(operation, ems_bus_id(), dest, type_id, offset, message_data, message_length);
+    uint8_t priority = (operation != Telegram::Operation::TX_READ) ? TX_PRIO_WRITE : front ? TX_PRIO_VALIDATE : TX_PRIO_FETCH;
+
+    std::lock_guard<std::recursive_mutex> lock(tx_mutex_);
+
+    // a read request, the data is the length to read. Merge it with a pending read of the same telegram
+    if (operation == Telegram::Operation::TX_READ && message_length == 1 && validateid == 0
+        && merge_read(dest, type_id, offset, message_data[0], priority, front)) {
+        return;
+    }
+
+    auto telegram = make_telegram(operation, ems_bus_id(), dest, type_id, offset, message_data, message_length);
 
     LOG_DEBUG("New Tx [#%d] telegram, length %d", tx_telegram_id_, message_length);
 
-    // if the queue is full, make room by removing the last one
+    if (queue_telegram(std::move(telegram), false, validateid, priority, front, millis()) && validateid != 0) {
+        EMSESP::wait_validate(validateid);
+    }
+}
+
+// adds a telegram to the Tx queue, at the front or back of its priority class
+// if the queue is full the last telegram of the lowest class is dropped, or the new one if that has an even lower priority
+// returns false if the new telegram was dropped
+bool TxService::queue_telegram(std::shared_ptr<Telegram> && telegram,
+                               const bool                  retry,
+                               const uint16_t              validateid,
+                               const uint8_t               priority,
+                               const bool                  front,
+                               const uint32_t              queued_time) {
+    std::lock_guard<std::recursive_mutex> lock(tx_mutex_);
+
     if (tx_telegrams_.size() >= MAX_TX_TELEGRAMS) {
-        if (tx_telegrams_.front().telegram_->operation == Telegram::Operation::TX_WRITE) {
+        bool         drop_new  = tx_telegrams_.back().priority_ < priority;
+        const auto & dropped   = drop_new ? telegram : tx_telegrams_.back().telegram_;
+        bool         was_write = (dropped->operation == Telegram::Operation::TX_WRITE);
+        if (was_write) {
             telegram_write_fail_count_++;
         } else {
             telegram_read_fail_count_++;
         }
-        tx_telegrams_.pop_front();
+        LOG_DEBUG("Tx queue full, dropping %s to 0x%02X type 0x%02X", was_write ? "write" : "read", dropped->dest & 0x7F, dropped->type_id);
+        if (drop_new) {
+            return false;
+        }
+        tx_telegrams_.pop_back();
     }
 
-    if (front) {
-        tx_telegrams_.emplace_front(tx_telegram_id_++, std::move(telegram), false, validateid); // add to front of queue
-    } else {
-        tx_telegrams_.emplace_back(tx_telegram_id_++, std::move(telegram), false, validateid); // add to back of queue
-    }
-    if (validateid != 0) {
-        EMSESP::wait_validate(validateid);
+    auto it = tx_telegrams_.begin();
+    while (it != tx_telegrams_.end() && (front ? it->priority_ < priority : it->priority_ <= priority)) {
+        it++;
     }
+    tx_telegrams_.emplace(it, tx_telegram_id_++, std::move(telegram), retry, validateid, priority, queued_time);
+    return true;
+}
+
+// merge a read request into a queued read from us of the same telegram, if the offsets overlap or are adjacent
+// and the combined length fits in one reply. The merged read takes the higher priority and the queue time of the queued one
+// returns true if the read was merged and must not be queued
+bool TxService::merge_read(const uint8_t dest, const uint16_t type_id, const uint8_t offset, const uint8_t length, const uint8_t priority, const bool front) {
+    std::lock_guard<std::recursive_mutex> lock(tx_mutex_);
+
+    uint8_t  max_length = (type_id > 0xFF) ? (EMS_MAX_TELEGRAM_MESSAGE_LENGTH - 2) : EMS_MAX_TELEGRAM_MESSAGE_LENGTH;
+    uint16_t end        = offset + ((length && length < max_length) ? length : max_length);
+
+    for (auto it = tx_telegrams_.begin(); it != tx_telegrams_.end(); it++) {
+        const auto & queued = it->telegram_;
+        if (it->retry_ || it->validateid_ || queued->operation != Telegram::Operation::TX_READ || queued->message_length != 1 || queued->src != ems_bus_id()
+            || queued->dest != dest || queued->type_id != type_id) {
+            continue;
+        }
+        uint8_t  queued_length = (queued->message_data[0] && queued->message_data[0] < max_length) ? queued->message_data[0] : max_length;
+        uint16_t queued_end    = queued->offset + queued_length;
+        if (offset > queued_end || queued->offset > end) {
+            continue; // not overlapping or adjacent
+        }
+        uint8_t  merged_offset = std::min(offset, queued->offset);
+        uint16_t merged_end    = std::max(end, queued_end);
+        if (merged_end - merged_offset > max_length) {
+            continue;
+        }
+        uint8_t merged_length = merged_end - merged_offset;
+
+        telegram_merged_count_++;
+        if (merged_offset == queued->offset && merged_length == queued_length && it->priority_ <= priority) {
+            LOG_DEBUG("Tx read of type 0x%02X to 0x%02X already queued as [#%d]", type_id, dest & 0x7F, it->id_);
+            return true;
+        }
+
+        // replace the queued read with the merged one
+        uint8_t  merged_priority = std::min(priority, it->priority_);
+        uint32_t queued_time     = it->queued_time_;
+        tx_telegrams_.erase(it);
+        LOG_DEBUG("Tx read of type 0x%02X to 0x%02X merged, offset %d length %d", type_id, dest & 0x7F, merged_offset, merged_length);
+        queue_telegram(make_telegram(Telegram::Operation::TX_READ, ems_bus_id(), dest, type_id, merged_offset, &merged_length, 1),
+                       false,
+                       0,
+                       merged_priority,
+                       front || (merged_priority < priority),
+                       queued_time);
+        return true;
+    }
+
+    return false;
 }
 
 // builds a Tx telegram and adds to queue
@@ -524,28 +706,13 @@ void TxService::add(uint8_t operation, const uint8_t * data, const uint8_t lengt
         }
     }
 
-    auto telegram = std::make_shared<Telegram>(operation, src, dest, type_id, offset, message_data, message_length); // operation is TX_WRITE or TX_READ
-
-    // if the queue is full, make room by removing the last one
-    if (tx_telegrams_.size() >= MAX_TX_TELEGRAMS) {
-        if (tx_telegrams_.front().telegram_->operation == Telegram::Operation::TX_WRITE) {
-            telegram_write_fail_count_++;
-        } else {
-            telegram_read_fail_count_++;
-        }
-        tx_telegrams_.pop_front();
-    }
+    auto telegram = make_telegram(operation, src, dest, type_id, offset, message_data, message_length); // operation is TX_WRITE or TX_READ
 
     LOG_DEBUG("New Tx [#%d] telegram, length %d", tx_telegram_id_, message_length);
 
-    if (front) {
-        // tx_telegrams_.push_front(qtxt); // add to front of queue
-        tx_telegrams_.emplace_front(tx_telegram_id_++, std::move(telegram), false, validate_id); // add to front of queue
-    } else {
-        // tx_telegrams_.push_back(qtxt); // add to back of queue
-        tx_telegrams_.emplace_back(tx_telegram_id_++, std::move(telegram), false, validate_id); // add to back of queue
-    }
-    if (validate_id != 0) {
+    // raw telegrams are sent by the user, as are writes
+    uint8_t priority = (operation == Telegram::Operation::TX_READ && !front) ? TX_PRIO_FETCH : TX_PRIO_WRITE;
+    if (queue_telegram(std::move(telegram), false, validate_id, priority, front, millis()) && validate_id != 0) {
         EMSESP::wait_validate(validate_id);
     }
 }
@@ -624,12 +791,10 @@ void TxService::retry_tx(const uint8_t operation, const uint8_t * data, const ui
               telegram_last_->to_string().c_str(),
               Helpers::data_to_hex(data, length - 1).c_str());
 
-    // add to the top of the queue
-    if (tx_telegrams_.size() >= MAX_TX_TELEGRAMS) {
-        tx_telegrams_.pop_back();
-    }
+    EMSESP::busstats_.tx_retry(telegram_last_->type_id);
 
-    tx_telegrams_.emplace_front(tx_telegram_id_++, std::move(telegram_last_), true, get_post_send_query());
+    // add to the top of the retry class, after writes and validation reads
+    queue_telegram(std::move(telegram_last_), true, get_post_send_query(), TX_PRIO_RETRY, true, millis());
 }
 
 // send a request to read the next block of data from longer telegrams
@@ -21,6 +21,10 @@
 
 #include <string>
 #include <deque>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <mutex>
 
 // UART drivers
 #if defined(ESP32)
@@ -151,6 +155,81 @@ class Telegram {
     int8_t _getDataPosition(const uint8_t index, const uint8_t size) const;
 };
 
+// fixed size pool of memory blocks for the short-lived Rx and Tx telegrams, to stop them fragmenting the heap
+// each block holds a telegram together with its shared_ptr reference count, see make_telegram()
+// when the pool is exhausted it falls back to the heap
+class TelegramPool {
+  public:
+    static constexpr size_t  BLOCK_SIZE = sizeof(Telegram) + 4 * sizeof(void *);      // telegram plus the shared_ptr control block
+    static constexpr uint8_t POOL_SIZE  = MAX_RX_TELEGRAMS + MAX_TX_TELEGRAMS + 4; // queues plus the ones being processed or sent
+
+    static void * allocate(const size_t size);
+    static void   deallocate(void * p);
+
+    static uint8_t in_use() {
+        return in_use_;
+    }
+
+    static uint8_t high_water() {
+        return high_water_;
+    }
+
+    static uint32_t fallback_count() {
+        return fallback_count_;
+    }
+
+  private:
+    union Block {
+        Block *  next_;
+        uint64_t align_;
+        uint8_t  data_[BLOCK_SIZE];
+    };
+
+    static Block      blocks_[POOL_SIZE];
+    static Block *    free_list_;
+    static bool       initialized_;
+    static uint8_t    in_use_;
+    static uint8_t    high_water_;
+    static uint32_t   fallback_count_;
+    static std::mutex mutex_; // telegrams are created in both the UART task and the main loop
+};
+
+// minimal allocator for std::allocate_shared, taking its memory from the TelegramPool
+template <typename T>
+class TelegramAllocator {
+  public:
+    using value_type = T;
+
+    TelegramAllocator() = default;
+    template <typename U>
+    TelegramAllocator(const TelegramAllocator<U> &) {
+    }
+
+    T * allocate(const size_t n) {
+        return static_cast<T *>(TelegramPool::allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T * p, const size_t) {
+        TelegramPool::deallocate(p);
+    }
+
+    template <typename U>
+    bool operator==(const TelegramAllocator<U> &) const {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const TelegramAllocator<U> &) const {
+        return false;
+    }
+};
+
+// creates a new telegram in the TelegramPool, use instead of std::make_shared<Telegram>
+template <typename... Args>
+std::shared_ptr<Telegram> make_telegram(Args &&... args) {
+    return std::allocate_shared<Telegram>(TelegramAllocator<Telegram>(), std::forward<Args>(args)...);
+}
+
 class EMSbus {
   public:
     static uuid::log::Logger logger_;
@@ -259,42 +338,55 @@ class RxService : public EMSbus {
     }
 
     uint32_t telegram_error_count() const {
-        return telegram_error_count_;
+        return telegram_error_count_ + telegram_oversize_count_;
+    }
+
+    uint32_t telegram_overflow_count() const {
+        return telegram_overflow_count_;
+    }
+
+    uint8_t queue_max() const {
+        return queue_max_;
     }
 
     // returns a %
     uint8_t quality() const {
-        if (telegram_error_count_ == 0) {
+        uint32_t errors = telegram_error_count();
+        if (errors == 0) {
             return 100; // all good, 100%
         }
-        uint8_t q = (telegram_error_count_ * 100 / (telegram_count_ + telegram_error_count_));
+        uint8_t q = (errors * 100 / (telegram_count_ + errors));
         return (q <= EMS_BUS_QUALITY_RX_THRESHOLD ? 100 : 100 - q);
     }
 
-    struct QueuedRxTelegram {
-      public:
-        const uint16_t                        id_;
-        const std::shared_ptr<const Telegram> telegram_;
-
-        ~QueuedRxTelegram() = default;
-        QueuedRxTelegram(uint16_t id, std::shared_ptr<Telegram> && telegram)
-            : id_(id)
-            , telegram_(std::move(telegram)) {
-        }
+    // a raw frame as received from the UART, including the CRC
+    struct QueuedRxFrame {
+        uint8_t id_;
+        uint8_t length_;
+        uint8_t data_[EMS_MAX_TELEGRAM_LENGTH];
     };
 
-    std::deque<QueuedRxTelegram> queue() const {
-        return rx_telegrams_;
-    }
+    std::vector<QueuedRxFrame> queue() const;
 
   private:
-    static constexpr uint8_t EMS_BUS_QUALITY_RX_THRESHOLD = 5; // % threshold before reporting quality issues
-
-    uint8_t                         rx_telegram_id_       = 0; // queue counter
-    uint32_t                        telegram_count_       = 0; // # Rx received
-    uint32_t                        telegram_error_count_ = 0; // # Rx CRC errors
-    std::shared_ptr<const Telegram> rx_telegram;               // the incoming Rx telegram
-    std::deque<QueuedRxTelegram>    rx_telegrams_;             // the Rx Queue
+    static constexpr uint8_t EMS_BUS_QUALITY_RX_THRESHOLD = 5;                    // % threshold before reporting quality issues
+    static constexpr uint8_t RX_RING_SIZE                 = MAX_RX_TELEGRAMS + 1; // one slot is always kept free
+
+    void queue_frame(const uint8_t * data, const uint8_t length);
+    void process_frame(const uint8_t * data, const uint8_t length);
+
+    uint8_t  rx_telegram_id_          = 0; // queue counter
+    uint32_t telegram_count_          = 0; // # Rx received
+    uint32_t telegram_error_count_    = 0; // # Rx CRC errors, counted in loop()
+    uint32_t telegram_overflow_count_ = 0; // # Rx frames dropped because the queue was full
+    uint32_t telegram_oversize_count_ = 0; // # Rx frames dropped because they are too long, counted from the UART task
+    uint8_t  queue_max_               = 0; // high-water mark of the queue
+
+    // the Rx queue, a single-producer/single-consumer ring without locks or allocations
+    // add() is called from the UART task and only writes rx_head_, loop() runs in the main loop and only writes rx_tail_
+    QueuedRxFrame        rx_frames_[RX_RING_SIZE];
+    std::atomic<uint8_t> rx_head_{0};
+    std::atomic<uint8_t> rx_tail_{0};
 };
 
 class TxService : public EMSbus {
@@ -302,6 +394,15 @@ class TxService : public EMSbus {
     static constexpr uint8_t TX_WRITE_FAIL    = 4; // EMS return code for fail
     static constexpr uint8_t TX_WRITE_SUCCESS = 1; // EMS return code for success
 
+    // priority classes of the Tx queue, lower is sent first
+    // a telegram is queued at the front or back of its class, the queue stays sorted by class
+    enum TxPriority : uint8_t {
+        TX_PRIO_WRITE    = 0, // writes and raw telegrams
+        TX_PRIO_VALIDATE = 1, // reads sent to the front: post-write validation, follow-up blocks of long telegrams, console reads
+        TX_PRIO_RETRY    = 2, // failed telegrams sent again
+        TX_PRIO_FETCH    = 3  // periodic fetches and other background reads
+    };
+
     TxService()  = default;
     ~TxService() = default;
 
@@ -372,6 +473,10 @@ class TxService : public EMSbus {
         return telegram_write_fail_count_;
     }
 
+    uint32_t telegram_merged_count() const {
+        return telegram_merged_count_;
+    }
+
     void telegram_fail_count(uint32_t telegram_fail_count) {
         telegram_read_fail_count_  = telegram_fail_count;
         telegram_write_fail_count_ = telegram_fail_count;
@@ -399,26 +504,33 @@ class TxService : public EMSbus {
         telegram_write_fail_count_++;
     }
 
+    // not const, telegrams are inserted and removed in the middle of the queue
     struct QueuedTxTelegram {
-        const uint16_t                        id_;
-        const std::shared_ptr<const Telegram> telegram_;
-        const bool                            retry_; // true if its a retry
-        const uint16_t                        validateid_;
+        uint16_t                        id_;
+        std::shared_ptr<const Telegram> telegram_;
+        bool                            retry_; // true if its a retry
+        uint16_t                        validateid_;
+        uint8_t                         priority_;    // TxPriority::
+        uint32_t                        queued_time_; // millis() when added to the queue
 
         ~QueuedTxTelegram() = default;
-        QueuedTxTelegram(uint16_t id, std::shared_ptr<Telegram> && telegram, bool retry, uint16_t validateid)
+        QueuedTxTelegram(uint16_t id, std::shared_ptr<Telegram> && telegram, bool retry, uint16_t validateid, uint8_t priority, uint32_t queued_time)
             : id_(id)
             , telegram_(std::move(telegram))
             , retry_(retry)
-            , validateid_(validateid) {
+            , validateid_(validateid)
+            , priority_(priority)
+            , queued_time_(queued_time) {
         }
     };
 
     std::deque<QueuedTxTelegram> queue() const {
+        std::lock_guard<std::recursive_mutex> lock(tx_mutex_);
         return tx_telegrams_;
     }
 
     bool tx_queue_empty() const {
+        std::lock_guard<std::recursive_mutex> lock(tx_mutex_);
         return tx_telegrams_.empty();
     }
 
@@ -432,11 +544,13 @@ class TxService : public EMSbus {
 
   private:
     std::deque<QueuedTxTelegram> tx_telegrams_; // the Tx queue
+    mutable std::recursive_mutex tx_mutex_;     // the queue is changed from both the UART task and the main loop
 
     uint32_t telegram_read_count_       = 0; // # Tx successful reads
     uint32_t telegram_write_count_      = 0; // # Tx successful writes
     uint32_t telegram_read_fail_count_  = 0; // # Tx unsuccessful transmits
     uint32_t telegram_write_fail_count_ = 0; // # Tx unsuccessful transmits
+    uint32_t telegram_merged_count_     = 0; // # Tx reads merged into one already queued
 
     std::shared_ptr<Telegram> telegram_last_;
     uint16_t                  telegram_last_post_send_query_; // which type ID to query after a successful send, to read back the values just written
@@ -446,6 +560,13 @@ class TxService : public EMSbus {
     uint8_t tx_telegram_id_ = 0; // queue counter
 
     void send_telegram(const QueuedTxTelegram & tx_telegram);
+    bool queue_telegram(std::shared_ptr<Telegram> && telegram,
+                        const bool                  retry,
+                        const uint16_t              validateid,
+                        const uint8_t               priority,
+                        const bool                  front,
+                        const uint32_t              queued_time);
+    bool merge_read(const uint8_t dest, const uint16_t type_id, const uint8_t offset, const uint8_t length, const uint8_t priority, const bool front);
 };
 
 } // namespace emsesp
@@ -72,6 +72,7 @@ void TemperatureSensor::reload() {
     EMSESP::webSettingsService.read([&](WebSettings & settings) {
         dallas_gpio_ = settings.dallas_gpio;
         parasite_    = settings.dallas_parasite;
+        loop_budget_ = settings.dallas_budget;
     });
 
     for (auto & sensor : sensors_) {
@@ -80,148 +81,254 @@ void TemperatureSensor::reload() {
     }
 }
 
+// runs the 1-wire state machine in small steps until the loop time budget is used up
+// a step is a bus reset or a single byte, so EMS processing is never stalled for long
 void TemperatureSensor::loop() {
     if (!dallas_gpio_) {
         return; // dallas gpio is 0 (disabled)
     }
 
 #ifndef EMSESP_STANDALONE
+    uint32_t start = micros();
+    while (step() && (micros() - start < (uint32_t)loop_budget_ * 1000)) {
+        YIELD;
+    }
+    uint32_t loop_time = micros() - start;
+    if (loop_time > max_loop_time_) {
+        max_loop_time_ = loop_time;
+    }
+#endif
+}
+
+#ifndef EMSESP_STANDALONE
+// one step of the state machine, returns false when there is nothing more to do in this loop
+bool TemperatureSensor::step() {
     uint32_t time_now = uuid::get_uptime();
 
     if (state_ == State::IDLE) {
-        if (time_now - last_activity_ >= READ_INTERVAL_MS) {
+        if (time_now - last_activity_ < READ_INTERVAL_MS) {
+            return false;
+        }
 #ifdef EMSESP_DEBUG_SENSOR
-            LOG_DEBUG("Read sensor temperature");
+        LOG_DEBUG("Read sensor temperature");
 #endif
-            if (bus_.reset() || parasite_) {
-                YIELD;
-                bus_.skip();
-                bus_.write(CMD_CONVERT_TEMP, parasite_ ? 1 : 0);
-                state_     = State::READING;
-                scanretry_ = 0;
-            } else {
-                // no sensors found
-                if (sensors_.size()) {
-                    sensorfails_++;
-                    if (++scanretry_ > SCAN_MAX) { // every 30 sec
-                        scanretry_ = 0;
+        if (bus_.reset() || parasite_) {
+            YIELD;
+            bus_.skip();
+            bus_.write(CMD_CONVERT_TEMP, parasite_ ? 1 : 0);
+            state_     = State::READING;
+            scanretry_ = 0;
+        } else {
+            // no sensors found
+            if (sensors_.size()) {
+                sensorfails_++;
+                if (++scanretry_ > SCAN_MAX) { // every 30 sec
+                    scanretry_ = 0;
 #ifdef EMSESP_DEBUG_SENSOR
-                        LOG_ERROR("Bus reset failed");
+                    LOG_ERROR("Bus reset failed");
 #endif
-                        for (auto & sensor : sensors_) {
-                            sensor.temperature_c = EMS_VALUE_SHORT_NOTSET;
-                        }
+                    for (auto & sensor : sensors_) {
+                        sensor.temperature_c = EMS_VALUE_SHORT_NOTSET;
                     }
                 }
             }
-            last_activity_ = time_now;
         }
-    } else if (state_ == State::READING) {
+        last_activity_ = time_now;
+        return false;
+    }
+
+    if (state_ == State::READING) {
         if (temperature_convert_complete() && (time_now - last_activity_ > CONVERSION_MS)) {
+            if (!parasite_) {
+                bus_.depower();
+            }
+            // search the bus at startup, every SCAN_MAX cycles and after a failed read, otherwise read the known sensors
+            if (scancnt_ <= 0 || rescan_ || sensors_.empty()) {
 #ifdef EMSESP_DEBUG_SENSOR
-            LOG_DEBUG("Scanning for temperature sensors");
+                LOG_DEBUG("Scanning for temperature sensors");
 #endif
-            bus_.reset_search();
-            state_ = State::SCANNING;
-        } else if (time_now - last_activity_ > READ_TIMEOUT_MS) {
+                bus_.reset_search();
+                rescan_        = false;
+                state_         = State::SCANNING;
+                last_progress_ = time_now;
+            } else {
+                start_read(0);
+            }
+            return true;
+        }
+        if (time_now - last_activity_ > READ_TIMEOUT_MS) {
 #ifdef EMSESP_DEBUG_SENSOR
             LOG_WARNING("Sensor read timeout");
 #endif
             state_ = State::IDLE;
             sensorfails_++;
         }
-    } else if (state_ == State::SCANNING) {
-        if (time_now - last_activity_ > SCAN_TIMEOUT_MS) {
+        return false;
+    }
+
+    if (time_now - last_progress_ > SCAN_TIMEOUT_MS) {
 #ifdef EMSESP_DEBUG_SENSOR
-            LOG_ERROR("Sensor scan timeout");
+        LOG_ERROR("Sensor scan timeout");
 #endif
-            state_ = State::IDLE;
+        state_ = State::IDLE;
+        sensorfails_++;
+        return false;
+    }
+
+    if (state_ == State::SCANNING) {
+        last_progress_         = time_now;
+        uint8_t addr[ADDR_LEN] = {0};
+        if (!bus_.search(addr)) {
+            if (!parasite_) {
+                bus_.depower();
+            }
+            start_read(0); // search done, now read all sensors
+            return true;
+        }
+        if (!parasite_) {
+            bus_.depower();
+        }
+        if (bus_.crc8(addr, ADDR_LEN - 1) != addr[ADDR_LEN - 1]) {
             sensorfails_++;
+            LOG_ERROR("Invalid sensor %s", Sensor(addr).id().c_str());
+            return true;
+        }
+        switch (addr[0]) {
+        case TYPE_DS18B20:
+        case TYPE_DS18S20:
+        case TYPE_DS1822:
+        case TYPE_DS1825: {
+            // add new sensor. this will create the id string, empty name and offset
+            bool found = false;
+            for (const auto & sensor : sensors_) {
+                if (sensor.internal_id() == get_id(addr)) {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found && (sensors_.size() < (MAX_SENSORS - 1))) {
+                sensors_.emplace_back(addr);
+                changed_ = true;
+                // look in the customization service for an optional alias or offset for that particular sensor
+                sensors_.back().apply_customization();
+            }
+            break;
+        }
+        default:
+            sensorfails_++;
+            LOG_ERROR("Unknown sensor %s", Sensor(addr).id().c_str());
+            break;
+        }
+        return true;
+    }
+
+    // State::READING_SENSOR, select one sensor and read its scratchpad a byte at a time
+    if (read_index_ >= sensors_.size()) {
+        end_scan();
+        return false;
+    }
+    Sensor & sensor = sensors_[read_index_];
+    if (read_step_ == STEP_RESET) {
+        if (!bus_.reset()) {
+            LOG_ERROR("Bus reset failed before reading scratchpad from %s", sensor.id().c_str());
+            read_failed(sensor);
+            return true;
+        }
+        bus_.write(CMD_MATCH_ROM);
+    } else if (read_step_ < STEP_COMMAND) {
+        bus_.write(sensor.addr()[read_step_ - STEP_SELECT]);
+    } else if (read_step_ == STEP_COMMAND) {
+        bus_.write(CMD_READ_SCRATCHPAD);
+    } else if (read_step_ < STEP_CHECK) {
+        scratchpad_[read_step_ - STEP_READ] = bus_.read();
+    } else {
+        if (!bus_.reset()) {
+            LOG_ERROR("Bus reset failed after reading scratchpad from %s", sensor.id().c_str());
+            read_failed(sensor);
+            return true;
+        }
+        if (bus_.crc8(scratchpad_, SCRATCHPAD_LEN - 1) != scratchpad_[SCRATCHPAD_LEN - 1]) {
+            LOG_WARNING("Invalid scratchpad CRC: %02X%02X%02X%02X%02X%02X%02X%02X%02X from sensor %s",
+                        scratchpad_[0],
+                        scratchpad_[1],
+                        scratchpad_[2],
+                        scratchpad_[3],
+                        scratchpad_[4],
+                        scratchpad_[5],
+                        scratchpad_[6],
+                        scratchpad_[7],
+                        scratchpad_[8],
+                        sensor.id().c_str());
+            sensor.crc_fails++;
+            crcfails_++;
+            read_failed(sensor);
+            return true;
+        }
+        int16_t t = get_temperature_c(sensor.addr(), scratchpad_);
+        if ((t >= -550) && (t <= 1250)) {
+            sensorreads_++;
+            t += sensor.offset();
+            if (t != sensor.temperature_c) {
+                sensor.temperature_c = t;
+                publish_sensor(sensor);
+                changed_ |= true;
+            }
+            sensor.read = true;
         } else {
-            uint8_t addr[ADDR_LEN] = {0};
+            sensorfails_++;
+        }
+        start_read(read_index_ + 1);
+        return true;
+    }
+    read_step_++;
+    return true;
+}
 
-            if (bus_.search(addr)) {
-                if (!parasite_) {
-                    bus_.depower();
-                }
-                if (bus_.crc8(addr, ADDR_LEN - 1) == addr[ADDR_LEN - 1]) {
-                    switch (addr[0]) {
-                    case TYPE_DS18B20:
-                    case TYPE_DS18S20:
-                    case TYPE_DS1822:
-                    case TYPE_DS1825:
-                        int16_t t;
-                        t = get_temperature_c(addr);
-                        if ((t >= -550) && (t <= 1250)) {
-                            sensorreads_++;
-                            // check if we already have this sensor
-                            bool found = false;
-                            for (auto & sensor : sensors_) {
-                                if (sensor.internal_id() == get_id(addr)) {
-                                    t += sensor.offset();
-                                    if (t != sensor.temperature_c) {
-                                        sensor.temperature_c = t;
-                                        publish_sensor(sensor);
-                                        changed_ |= true;
-                                    }
-                                    sensor.read = true;
-                                    found       = true;
-                                    break;
-                                }
-                            }
-                            // add new sensor. this will create the id string, empty name and offset
-                            if (!found && (sensors_.size() < (MAX_SENSORS - 1))) {
-                                sensors_.emplace_back(addr);
-                                sensors_.back().read = true;
-                                changed_             = true;
-                                // look in the customization service for an optional alias or offset for that particular sensor
-                                sensors_.back().apply_customization();
-                                sensors_.back().temperature_c = t + sensors_.back().offset();
-                                publish_sensor(sensors_.back()); // call publish single
-                                // sort the sensors based on name
-                                // std::sort(sensors_.begin(), sensors_.end(), [](const Sensor & a, const Sensor & b) { return a.name() < b.name(); });
-                            }
-                        } else {
-                            sensorfails_++;
-                        }
-                        break;
+// start reading the scratchpad of a sensor
+void TemperatureSensor::start_read(const uint8_t index) {
+    state_         = State::READING_SENSOR;
+    read_index_    = index;
+    read_step_     = STEP_RESET;
+    read_retry_    = 0;
+    last_progress_ = uuid::get_uptime();
+}
 
-                    default:
-                        sensorfails_++;
-                        LOG_ERROR("Unknown sensor %s", Sensor(addr).id().c_str());
-                        break;
-                    }
-                } else {
-                    sensorfails_++;
-                    LOG_ERROR("Invalid sensor %s", Sensor(addr).id().c_str());
-                }
-            } else {
-                if (!parasite_) {
-                    bus_.depower();
-                }
-                // check for missing sensors after some samples
-                if (++scancnt_ > SCAN_MAX) {
-                    for (auto & sensor : sensors_) {
-                        if (!sensor.read) {
-                            sensor.temperature_c = EMS_VALUE_SHORT_NOTSET;
-                            changed_             = true;
-                        }
-                        sensor.read = false;
-                    }
-                    scancnt_ = 0;
-                } else if (scancnt_ == SCAN_START + 1) { // startup
-                    firstscan_ = sensors_.size();
-                    // LOG_DEBUG("Adding %d sensor(s) from first scan", firstscan_);
-                } else if ((scancnt_ <= 0) && (firstscan_ != sensors_.size())) { // check 2 times for no change of sensor #
-                    scancnt_ = SCAN_START;
-                    sensors_.clear(); // restart scanning and clear to get correct numbering
-                }
-                state_ = State::IDLE;
+// retry the read of the sensor, or give up and search the bus in the next cycle
+void TemperatureSensor::read_failed(Sensor & sensor) {
+    if (read_retry_ < READ_RETRIES) {
+        read_retry_++;
+        sensor.retries++;
+        retries_++;
+        read_step_     = STEP_RESET;
+        last_progress_ = uuid::get_uptime();
+        return;
+    }
+    sensorfails_++;
+    rescan_ = true; // the sensor may have been removed or replaced
+    start_read(read_index_ + 1);
+}
+
+// all sensors are read, check for missing sensors after some samples
+void TemperatureSensor::end_scan() {
+    if (++scancnt_ > SCAN_MAX) {
+        for (auto & sensor : sensors_) {
+            if (!sensor.read) {
+                sensor.temperature_c = EMS_VALUE_SHORT_NOTSET;
+                changed_             = true;
             }
+            sensor.read = false;
         }
+        scancnt_ = 0;
+    } else if (scancnt_ == SCAN_START + 1) { // startup
+        firstscan_ = sensors_.size();
+        // LOG_DEBUG("Adding %d sensor(s) from first scan", firstscan_);
+    } else if ((scancnt_ <= 0) && (firstscan_ != sensors_.size())) { // check 2 times for no change of sensor #
+        scancnt_ = SCAN_START;
+        sensors_.clear(); // restart scanning and clear to get correct numbering
     }
-#endif
+    state_ = State::IDLE;
 }
+#endif
 
 bool TemperatureSensor::temperature_convert_complete() {
 #ifndef EMSESP_STANDALONE
@@ -234,41 +341,8 @@ bool TemperatureSensor::temperature_convert_complete() {
 #endif
 }
 
-int16_t TemperatureSensor::get_temperature_c(const uint8_t addr[]) {
-#ifndef EMSESP_STANDALONE
-    if (!bus_.reset()) {
-        LOG_ERROR("Bus reset failed before reading scratchpad from %s", Sensor(addr).id().c_str());
-        return EMS_VALUE_SHORT_NOTSET;
-    }
-    YIELD;
-
-    uint8_t scratchpad[SCRATCHPAD_LEN] = {0};
-    bus_.select(addr);
-    bus_.write(CMD_READ_SCRATCHPAD);
-    bus_.read_bytes(scratchpad, SCRATCHPAD_LEN);
-    YIELD;
-
-    if (!bus_.reset()) {
-        LOG_ERROR("Bus reset failed after reading scratchpad from %s", Sensor(addr).id().c_str());
-        return EMS_VALUE_SHORT_NOTSET;
-    }
-    YIELD;
-
-    if (bus_.crc8(scratchpad, SCRATCHPAD_LEN - 1) != scratchpad[SCRATCHPAD_LEN - 1]) {
-        LOG_WARNING("Invalid scratchpad CRC: %02X%02X%02X%02X%02X%02X%02X%02X%02X from sensor %s",
-                    scratchpad[0],
-                    scratchpad[1],
-                    scratchpad[2],
-                    scratchpad[3],
-                    scratchpad[4],
-                    scratchpad[5],
-                    scratchpad[6],
-                    scratchpad[7],
-                    scratchpad[8],
-                    Sensor(addr).id().c_str());
-        return EMS_VALUE_SHORT_NOTSET;
-    }
-
+// the temperature from a scratchpad with a valid CRC
+int16_t TemperatureSensor::get_temperature_c(const uint8_t addr[], const uint8_t scratchpad[]) {
     int16_t raw_value = ((int16_t)scratchpad[SCRATCHPAD_TEMP_MSB] << 8) | scratchpad[SCRATCHPAD_TEMP_LSB];
 
     if (addr[0] == TYPE_DS18S20) {
@@ -292,9 +366,6 @@ int16_t TemperatureSensor::get_temperature_c(const uint8_t addr[]) {
     }
     raw_value = ((int32_t)raw_value * 625 + 500) / 1000; // round to 0.1
     return raw_value;
-#else
-    return EMS_VALUE_SHORT_NOTSET;
-#endif
 }
 
 // update temperature sensor information name and offset
@@ -568,6 +639,7 @@ void TemperatureSensor::publish_values(const bool force) {
 TemperatureSensor::Sensor::Sensor(const uint8_t addr[])
     : internal_id_(((uint64_t)addr[0] << 48) | ((uint64_t)addr[1] << 40) | ((uint64_t)addr[2] << 32) | ((uint64_t)addr[3] << 24) | ((uint64_t)addr[4] << 16)
                    | ((uint64_t)addr[5] << 8) | ((uint64_t)addr[6])) {
+    memcpy(addr_, addr, sizeof(addr_));
     // create ID string
     char id_s[20];
     snprintf(id_s,
@@ -60,13 +60,20 @@ class TemperatureSensor {
             name_ = name;
         }
 
+        const uint8_t * addr() const {
+            return addr_;
+        }
+
         bool apply_customization();
 
-        int16_t temperature_c = EMS_VALUE_SHORT_NOTSET;
-        bool    read          = false;
-        bool    ha_registered = false;
+        int16_t  temperature_c = EMS_VALUE_SHORT_NOTSET;
+        bool     read          = false;
+        bool     ha_registered = false;
+        uint32_t crc_fails     = 0; // # scratchpad reads with a bad CRC
+        uint32_t retries       = 0; // # reads repeated after a bad CRC or bus reset
 
       private:
+        uint8_t     addr_[8]; // 1-wire ROM address, including the CRC
         uint64_t    internal_id_;
         std::string id_;
         std::string name_;
@@ -97,6 +104,18 @@ class TemperatureSensor {
         return sensorfails_;
     }
 
+    uint32_t crc_fails() {
+        return crcfails_;
+    }
+
+    uint32_t retries() {
+        return retries_;
+    }
+
+    uint32_t max_loop_time() {
+        return max_loop_time_;
+    }
+
     bool sensor_enabled() {
         return (dallas_gpio_ != 0);
     }
@@ -118,7 +137,7 @@ class TemperatureSensor {
   private:
     static constexpr uint8_t MAX_SENSORS = 20;
 
-    enum class State { IDLE, READING, SCANNING };
+    enum class State { IDLE, READING, SCANNING, READING_SENSOR };
 
     static constexpr size_t ADDR_LEN = 8;
 
@@ -137,10 +156,20 @@ class TemperatureSensor {
     static constexpr uint32_t READ_INTERVAL_MS = 5000; // 5 seconds
     static constexpr uint32_t CONVERSION_MS    = 1000; // 1 seconds
     static constexpr uint32_t READ_TIMEOUT_MS  = 2000; // 2 seconds
-    static constexpr uint32_t SCAN_TIMEOUT_MS  = 3000; // 3 seconds
+    static constexpr uint32_t SCAN_TIMEOUT_MS  = 4000; // 4 seconds without progress, for a search step or the read of one sensor
 
     static constexpr uint8_t CMD_CONVERT_TEMP    = 0x44;
     static constexpr uint8_t CMD_READ_SCRATCHPAD = 0xBE;
+    static constexpr uint8_t CMD_MATCH_ROM       = 0x55;
+
+    // steps of reading a sensor, each is a bus reset or a single byte
+    static constexpr uint8_t STEP_RESET   = 0;                          // reset and match ROM command
+    static constexpr uint8_t STEP_SELECT  = 1;                          // 8 bytes of the address
+    static constexpr uint8_t STEP_COMMAND = STEP_SELECT + ADDR_LEN;     // read scratchpad command
+    static constexpr uint8_t STEP_READ    = STEP_COMMAND + 1;           // 9 bytes of the scratchpad
+    static constexpr uint8_t STEP_CHECK   = STEP_READ + SCRATCHPAD_LEN; // reset and check the CRC
+
+    static constexpr uint8_t READ_RETRIES = 2;
 
     static constexpr int8_t SCAN_START = -3;
     static constexpr int8_t SCAN_MAX   = 5;
@@ -148,7 +177,7 @@ class TemperatureSensor {
     static uuid::log::Logger logger_;
 
     bool     temperature_convert_complete();
-    int16_t  get_temperature_c(const uint8_t addr[]);
+    int16_t  get_temperature_c(const uint8_t addr[], const uint8_t scratchpad[]);
     uint64_t get_id(const uint8_t addr[]);
     void     remove_ha_topic(const std::string & id);
 
@@ -158,19 +187,34 @@ class TemperatureSensor {
     std::vector<Sensor> sensors_; // our list of active sensors
 
 #ifndef EMSESP_STANDALONE
+    bool step();
+    void start_read(const uint8_t index);
+    void read_failed(Sensor & sensor);
+    void end_scan();
+
     OneWire  bus_;
     uint32_t last_activity_ = uuid::get_uptime();
+    uint32_t last_progress_ = 0; // last search step or start of a sensor read, the timeout does not depend on the number of sensors
     State    state_         = State::IDLE;
     int8_t   scancnt_       = SCAN_START;
     uint8_t  firstscan_     = 0;
     int8_t   scanretry_     = 0;
+    bool     rescan_        = false; // search the bus in the next cycle
+    uint8_t  read_index_    = 0;     // sensor being read
+    uint8_t  read_step_     = 0;
+    uint8_t  read_retry_    = 0;
+    uint8_t  scratchpad_[SCRATCHPAD_LEN];
 #endif
 
-    uint8_t  dallas_gpio_ = 0;
-    bool     parasite_    = false;
-    bool     changed_     = false;
-    uint32_t sensorfails_ = 0;
-    uint32_t sensorreads_ = 0;
+    uint8_t  dallas_gpio_   = 0;
+    bool     parasite_      = false;
+    uint8_t  loop_budget_   = 2; // ms per loop for the 1-wire steps
+    bool     changed_       = false;
+    uint32_t sensorfails_   = 0;
+    uint32_t sensorreads_   = 0;
+    uint32_t crcfails_      = 0;
+    uint32_t retries_       = 0;
+    uint32_t max_loop_time_ = 0; // us
 };
 
 } // namespace emsesp
@@ -21,6 +21,38 @@
 
 #include "test.h"
 
+#ifdef EMSESP_STANDALONE
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <new>
+
+// count heap allocations so the replay benchmark can report them per telegram
+static std::atomic<bool>     count_allocs_(false);
+static std::atomic<uint32_t> alloc_count_(0);
+
+void * operator new(size_t size) {
+    if (count_allocs_) {
+        alloc_count_++;
+    }
+    void * p = malloc(size ? size : 1);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+// noinline, otherwise gcc sees free() on memory from new and reports a mismatch
+__attribute__((noinline)) void operator delete(void * p) noexcept {
+    free(p);
+}
+
+__attribute__((noinline)) void operator delete(void * p, size_t size) noexcept {
+    free(p);
+}
+#endif
+
 namespace emsesp {
 
 // no shell, called via the API or 'call system test' command
@@ -716,6 +748,17 @@ void Test::run_test(uuid::console::Shell & shell, const std::string & cmd, const
         ok = true;
     }
 
+    if (command == "pulses") {
+        shell.printfln("Testing pulse counting on digital inputs");
+        uint16_t count = data.empty() ? 100 : Helpers::atoint(data.c_str());
+        EMSESP::analogsensor_.update(33, "gas", 0, 1, 0, AnalogSensor::AnalogType::COUNTER);
+        EMSESP::analogsensor_.update(35, "flow", 0, 1, 0, AnalogSensor::AnalogType::RATE);
+        EMSESP::analogsensor_.test_pulses(33, count, 50); // 20Hz
+        EMSESP::analogsensor_.test_pulses(35, 10, 250);   // 4Hz
+        shell.invoke_command("show values");
+        ok = true;
+    }
+
     if (command == "healthcheck") {
         uint8_t n = 0;
         if (!data.empty()) {
@@ -1695,6 +1738,15 @@ void Test::run_test(uuid::console::Shell & shell, const std::string & cmd, const
         ok = true;
     }
 
+#ifdef EMSESP_STANDALONE
+    // replays a capture file with one telegram per line at full speed and reports the timings
+    // e.g. test replay src/test/capture.txt or a binary capture from 'call system capture'
+    if (command == "replay") {
+        replay(shell, data);
+        ok = true;
+    }
+#endif
+
     if (command == "crash") {
         shell.printfln("Forcing a crash...");
 #pragma GCC diagnostic push
@@ -1835,6 +1887,124 @@ void Test::add_device(uint8_t device_id, uint8_t product_id) {
     uart_telegram({device_id, EMSESP_DEFAULT_EMS_BUS_ID, EMSdevice::EMS_TYPE_VERSION, 0, product_id, 1, 0});
 }
 
+#ifdef EMSESP_STANDALONE
+// replay a recorded capture through incoming_telegram() as fast as possible
+// each line holds one telegram in hex including the CRC, like the 'Rx:' output of 'watch raw'
+// anything in front of 'Rx: ' is ignored, as are empty lines and lines starting with #
+// a binary capture saved with 'call system capture' or downloaded from the web is also accepted
+void Test::replay(uuid::console::Shell & shell, const std::string & filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (filename.empty() || !file.is_open()) {
+        shell.printfln("Cannot open capture file '%s'", filename.c_str());
+        return;
+    }
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    // read all telegrams first, so file I/O is not part of the timings
+    // a binary bus capture (see BusCapture) is replayed as recorded, including frames with a bad CRC
+    std::vector<std::vector<uint8_t>> frames;
+    if (BusCapture::parse((const uint8_t *)content.data(), content.size(), [&](const uint32_t delta, const uint8_t * frame, const uint8_t length, const bool crc_ok) {
+            frames.emplace_back(frame, frame + length);
+        })) {
+        content.clear();
+    }
+
+    std::istringstream lines(content);
+    std::string        line;
+    while (std::getline(lines, line)) {
+        size_t pos = line.find("Rx: ");
+        pos        = (pos == std::string::npos) ? 0 : pos + 4;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::vector<uint8_t> frame;
+        char *               end = nullptr;
+        const char *         p   = line.c_str() + pos;
+        while (frame.size() < EMS_MAX_TELEGRAM_LENGTH) {
+            long val = strtol(p, &end, 16);
+            if (end == p) {
+                break;
+            }
+            frame.push_back((uint8_t)val);
+            p = end;
+        }
+        while (isspace(*p)) {
+            p++;
+        }
+        if (*p == '\0' && frame.size() >= 5) { // skip lines that are not a telegram, e.g. other log output
+            frames.push_back(frame);
+        }
+    }
+
+    if (frames.empty()) {
+        shell.printfln("No telegrams found in '%s'", filename.c_str());
+        return;
+    }
+
+    struct DeviceStats {
+        uint32_t count;
+        uint64_t time_ns;
+    };
+    std::vector<DeviceStats> device_stats(EMSdevice::DeviceType::UNKNOWN + 1, {0, 0});
+
+    // logging to the console would dominate the timings
+    auto log_level = shell.log_level();
+    shell.log_level(uuid::log::Level::WARNING);
+    EMSESP::watch(EMSESP::Watch::WATCH_OFF);
+
+    uint32_t mqtt_count = Mqtt::publish_count();
+    uint32_t rx_count   = EMSESP::rxservice_.telegram_count();
+    alloc_count_        = 0;
+    count_allocs_       = true;
+
+    auto     start    = std::chrono::steady_clock::now();
+    uint64_t total_ns = 0;
+    for (auto & frame : frames) {
+        uint8_t device_type = EMSdevice::DeviceType::UNKNOWN;
+        for (const auto & emsdevice : EMSESP::emsdevices) {
+            if (emsdevice->is_device_id(frame[0] & 0x7F)) {
+                device_type = emsdevice->device_type();
+                break;
+            }
+        }
+
+        auto t0 = std::chrono::steady_clock::now();
+        EMSESP::incoming_telegram(frame.data(), frame.size());
+        EMSESP::rxservice_.loop();
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+
+        device_stats[device_type].count++;
+        device_stats[device_type].time_ns += ns;
+        total_ns += ns;
+    }
+    EMSESP::publish_all(); // publish what has changed, as the main loop would do
+    auto elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    count_allocs_ = false;
+    shell.log_level(log_level);
+
+    uint32_t count = frames.size();
+    shell.printfln("Replayed %u telegrams from '%s' (%u processed) in %.3f ms",
+                   count,
+                   filename.c_str(),
+                   EMSESP::rxservice_.telegram_count() - rx_count,
+                   elapsed_ns / 1e6);
+    shell.printfln(" %.0f telegrams/sec, %.2f us per telegram", count * 1e9 / (total_ns ? total_ns : 1), total_ns / 1e3 / count);
+    shell.printfln(" %u allocations, %.2f per telegram", alloc_count_.load(), (float)alloc_count_ / count);
+    shell.printfln(" %u MQTT messages", Mqtt::publish_count() - mqtt_count);
+    shell.printfln(" Processing time per device type:");
+    for (uint8_t i = 0; i < device_stats.size(); i++) {
+        if (device_stats[i].count) {
+            shell.printfln("  %-12s %6u telegrams, %8.2f us total, %6.2f us per telegram",
+                           (i == EMSdevice::DeviceType::UNKNOWN) ? "unknown" : EMSdevice::device_type_2_device_name(i),
+                           device_stats[i].count,
+                           device_stats[i].time_ns / 1e3,
+                           device_stats[i].time_ns / 1e3 / device_stats[i].count);
+        }
+    }
+}
+#endif
+
 #ifdef EMSESP_TEST
 #ifndef EMSESP_STANDALONE
 void Test::listDir(fs::FS & fs, const char * dirname, uint8_t levels) {
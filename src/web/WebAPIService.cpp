@@ -105,6 +105,11 @@ void WebAPIService::parse(AsyncWebServerRequest * request, JsonObject & input) {
     // capture current heap memory before allocating the large return buffer
     emsesp::EMSESP::system_.refreshHeapMem();
 
+    // device info and values are streamed without the large buffer
+    if (stream_device_info(request, input)) {
+        return;
+    }
+
     // output json buffer
     size_t buffer   = EMSESP_JSON_SIZE_XXXLARGE;
     auto * response = new PrettyAsyncJsonResponse(false, buffer);
@@ -160,6 +165,233 @@ void WebAPIService::parse(AsyncWebServerRequest * request, JsonObject & input) {
 #endif
 }
 
+// the info and values of EMS devices are the largest API responses. These are sent as a chunked response,
+// generating one entity at a time, instead of building the whole JSON document in one large buffer
+// uses the same path and query parameters as Command::process() for /api/{device}[/{hc}][/info|values]
+// returns false if it's another command, which is then handled by parse()
+bool WebAPIService::stream_device_info(AsyncWebServerRequest * request, JsonObject & input) {
+    if (input.containsKey("data") || input.containsKey("value") || input.containsKey("hc") || input.containsKey("wwc") || input.containsKey("id")
+        || input.containsKey("ahs") || input.containsKey("hs")) {
+        return false;
+    }
+
+    SUrlParser p;
+    p.parse(request->url().c_str());
+    if (p.paths().empty() || p.paths().front() != "api") {
+        return false;
+    }
+    p.paths().erase(p.paths().begin());
+    size_t num_paths = p.paths().size();
+
+    const char * device_s = nullptr;
+    std::string  command_s;
+    if (num_paths) {
+        device_s = p.paths().front().c_str();
+        for (size_t i = 1; i < num_paths && i < 4; i++) {
+            command_s += (i > 1 ? "/" : "") + p.paths()[i];
+        }
+    } else {
+        device_s = input["device"];
+        if (input.containsKey("entity")) {
+            command_s = input["entity"].as<std::string>();
+        } else if (input.containsKey("cmd")) {
+            command_s = input["cmd"].as<std::string>();
+        }
+    }
+
+    uint8_t device_type = EMSdevice::device_name_2_device_type(device_s);
+    if (!EMSESP::count_devices(device_type)) {
+        return false;
+    }
+
+    int8_t       id        = -1;
+    const char * command_p = Command::parse_command_string(command_s.empty() ? nullptr : command_s.c_str(), id);
+    if (command_p == nullptr) {
+        if (num_paths >= (id > 0 ? 4U : 3U)) {
+            return false;
+        }
+        command_p = F_(values); // default for /api/{device}
+    }
+
+    uint8_t output_target;
+    if (Helpers::toLower(command_p) == F_(info)) {
+        output_target = EMSdevice::OUTPUT_TARGET::API_VERBOSE;
+    } else if (Helpers::toLower(command_p) == F_(values)) {
+        output_target = EMSdevice::OUTPUT_TARGET::API_SHORTNAMES;
+    } else {
+        return false;
+    }
+    auto cf = Command::find_command(device_type, 0, command_p);
+    if (cf == nullptr || cf->has_flags(CommandFlag::ADMIN_ONLY)) {
+        return false;
+    }
+
+    // same tags as EMSESP::command_info()
+    uint8_t tag;
+    if (id >= 1 && id <= (1 + DeviceValueTAG::TAG_HS16 - DeviceValueTAG::TAG_HC1)) {
+        tag = DeviceValueTAG::TAG_HC1 + id - 1;
+    } else if (id == -1 || id == 0) {
+        tag = DeviceValueTAG::TAG_NONE;
+    } else {
+        return false;
+    }
+    bool nested = (id < 1 && output_target != EMSdevice::OUTPUT_TARGET::API_VERBOSE);
+
+    // generate up to the first value, if there is none the command reports the error
+    auto stream = std::make_shared<DeviceInfoStream>(device_type, tag, nested, output_target);
+    while (!stream->num_values() && stream->next()) {
+    }
+    if (!stream->num_values()) {
+        return false;
+    }
+
+    AsyncWebServerResponse * response =
+        request->beginChunkedResponse("application/json; charset=utf-8", [stream](uint8_t * buffer, size_t maxLen, size_t index) -> size_t {
+            return stream->fill(buffer, maxLen);
+        });
+    request->send(response);
+    api_count_++;
+
+    // same log as Command::call()
+    std::string ro          = EMSESP::system_.readonly_mode() ? "[readonly] " : "";
+    auto        description = Helpers::translated_word(cf->description_);
+    if (strlen(description)) {
+        EMSESP::logger().warning("%sCalling command '%s/%s' (%s)", ro.c_str(), EMSdevice::device_type_2_device_name(device_type), command_p, description);
+    } else {
+        EMSESP::logger().warning("%sCalling command '%s/%s'", ro.c_str(), EMSdevice::device_type_2_device_name(device_type), command_p);
+    }
+
+#if defined(EMSESP_STANDALONE)
+    Serial.print(COLOR_YELLOW);
+    Serial.print("web response code: ");
+    Serial.println(200);
+    uint8_t buffer[64];
+    size_t  len;
+    while ((len = stream->fill(buffer, sizeof(buffer))) > 0) {
+        Serial.write(buffer, len);
+    }
+    Serial.println();
+    Serial.print(COLOR_RESET);
+#endif
+
+    return true;
+}
+
+WebAPIService::DeviceInfoStream::DeviceInfoStream(const uint8_t device_type, const uint8_t tag, const bool nested, const uint8_t output_target)
+    : output_target_(output_target)
+    , nested_(nested) {
+    // nested output has all tags from the device data, see EMSESP::command_info()
+    tag_      = nested ? (uint8_t)DeviceValueTAG::TAG_BOILER_DATA_WW : tag;
+    tag_last_ = nested ? (uint8_t)DeviceValueTAG::TAG_HS16 : tag;
+    pending_  = "{";
+
+    for (const auto & emsdevice : EMSESP::emsdevices) {
+        if (emsdevice && (emsdevice->device_type() == device_type)) {
+            device_ids_.push_back(emsdevice->unique_id());
+        }
+    }
+}
+
+// the device of the stream at index, looked up again for each chunk as the device list may have been sorted
+// or nullptr if it was removed
+EMSdevice * WebAPIService::DeviceInfoStream::device(const size_t index) const {
+    for (const auto & emsdevice : EMSESP::emsdevices) {
+        if (emsdevice && emsdevice->unique_id() == device_ids_[index]) {
+            return emsdevice.get();
+        }
+    }
+    return nullptr;
+}
+
+// adds a member to the root object, or the nested object of the tag, formatted like serializeJsonPretty()
+void WebAPIService::DeviceInfoStream::add_member(const char * member, const bool in_tag) {
+    size_t & count = in_tag ? num_tag_members_ : num_members_;
+    pending_ += count++ ? ",\r\n" : "\r\n";
+    pending_ += in_tag ? "    " : "  ";
+    pending_ += member;
+}
+
+// generates the next part of the output, returns false when the output is complete
+bool WebAPIService::DeviceInfoStream::next() {
+    if (closed_) {
+        return false;
+    }
+
+    while (tag_ <= tag_last_) {
+        // open a nested object if any device has values with this tag
+        if (!tag_started_) {
+            tag_started_ = true;
+            if (nested_) {
+                for (size_t i = 0; i < device_ids_.size(); i++) {
+                    auto emsdevice = device(i);
+                    if (emsdevice && emsdevice->has_tags(tag_)) {
+                        std::string member = std::string("\"") + EMSdevice::tag_to_mqtt(tag_) + "\": {";
+                        add_member(member.c_str(), false);
+                        tag_open_        = true;
+                        num_tag_members_ = 0;
+                        return true;
+                    }
+                }
+            }
+        }
+
+        while (device_index_ < device_ids_.size()) {
+            auto emsdevice = device(device_index_);
+            if (emsdevice && (value_index_ < emsdevice->num_device_values())) {
+                StaticJsonDocument<EMSESP_JSON_SIZE_SMALL> doc;
+                JsonObject                                 output = doc.to<JsonObject>();
+                if (emsdevice->generate_value(output, value_index_++, tag_, output_target_)) {
+                    // the pretty json is "{\r\n  "name": value\r\n}", take out the member
+                    char json[EMSESP_JSON_SIZE_SMALL];
+                    serializeJsonPretty(output, json, sizeof(json));
+                    size_t len = strlen(json);
+                    if (len > 8) {
+                        json[len - 3] = '\0';
+                        add_member(json + 5, tag_open_);
+                        num_values_++;
+                        return true;
+                    }
+                }
+                continue;
+            }
+            device_index_++;
+            value_index_ = 0;
+        }
+
+        // end of this tag
+        if (tag_open_) {
+            pending_ += num_tag_members_ ? "\r\n  }" : "}";
+            tag_open_ = false;
+        }
+        tag_started_  = false;
+        device_index_ = 0;
+        tag_++;
+    }
+
+    pending_ += num_members_ ? "\r\n}" : "}";
+    closed_ = true;
+    return true;
+}
+
+// copies the output into the response buffer, returns the length or 0 when done
+size_t WebAPIService::DeviceInfoStream::fill(uint8_t * buffer, const size_t max_len) {
+    size_t len = 0;
+    while (len < max_len) {
+        if (pending_pos_ >= pending_.size()) {
+            pending_.clear();
+            pending_pos_ = 0;
+            if (!next()) {
+                break;
+            }
+        }
+        size_t n = std::min(max_len - len, pending_.size() - pending_pos_);
+        memcpy(buffer + len, pending_.data() + pending_pos_, n);
+        len += n;
+        pending_pos_ += n;
+    }
+    return len;
+}
+
 void WebAPIService::getSettings(AsyncWebServerRequest * request) {
     auto *     response = new AsyncJsonResponse(false, FS_BUFFER_SIZE);
     JsonObject root     = response->getRoot();
@@ -27,6 +27,8 @@
 
 namespace emsesp {
 
+class EMSdevice;
+
 class WebAPIService {
   public:
     WebAPIService(AsyncWebServer * server, SecurityManager * securityManager);
@@ -50,6 +52,43 @@ class WebAPIService {
     static uint16_t api_fails_;
 
     void parse(AsyncWebServerRequest * request, JsonObject & input);
+    bool stream_device_info(AsyncWebServerRequest * request, JsonObject & input);
+
+    // writes the info/values of all EMS devices of a type as pretty JSON, one entity at a time
+    // used for a chunked response so there is no need for a large contiguous JSON buffer
+    class DeviceInfoStream {
+      public:
+        DeviceInfoStream(const uint8_t device_type, const uint8_t tag, const bool nested, const uint8_t output_target);
+
+        bool   next();
+        size_t fill(uint8_t * buffer, const size_t max_len);
+
+        size_t num_values() const {
+            return num_values_;
+        }
+
+      private:
+        void        add_member(const char * member, const bool in_tag);
+        EMSdevice * device(const size_t index) const;
+
+        uint8_t output_target_;
+        uint8_t tag_;      // current tag
+        uint8_t tag_last_; // last tag to output
+        bool    nested_;   // each tag gets its own nested object
+
+        std::vector<uint8_t> device_ids_; // unique ids of the devices, EMSESP::emsdevices can change between chunks
+
+        bool        tag_started_     = false;
+        bool        tag_open_        = false; // a nested object is open for the tag
+        bool        closed_          = false; // the root object is closed
+        size_t      device_index_    = 0;     // position in device_ids_
+        size_t      value_index_     = 0;     // position in the device values of the current device
+        size_t      num_members_     = 0;     // members in the root object
+        size_t      num_tag_members_ = 0;     // members in the nested object of the tag
+        size_t      num_values_      = 0;
+        size_t      pending_pos_     = 0;
+        std::string pending_; // output not yet copied to the response
+    };
 
     void getSettings(AsyncWebServerRequest * request);
     void getCustomizations(AsyncWebServerRequest * request);
@@ -126,6 +126,7 @@ StateUpdateResult WebCustomEntity::update(JsonObject & root, WebCustomEntity & w
             }
         }
     }
+    EMSESP::webCustomEntityService.index_reset(); // the list is complete, get_value() rebuilds the index under the same lock
     return StateUpdateResult::CHANGED;
 }
 
@@ -535,18 +536,52 @@ void WebCustomEntityService::fetch() {
     // EMSESP::logger().debug("fetch custom entities");
 }
 
+// index of the entities sorted by source device and type id, rebuilt after the entities have changed
+// called with the service locked
+void WebCustomEntityService::build_index(std::list<CustomEntityItem> & entities) {
+    entity_index_.clear();
+    entity_index_.reserve(entities.size());
+    for (auto & entity : entities) {
+        entity_index_.push_back({((uint32_t)entity.device_id << 16) | entity.type_id, &entity});
+    }
+    std::stable_sort(entity_index_.begin(), entity_index_.end(), [](const CustomEntityIndex & a, const CustomEntityIndex & b) { return a.key_ < b.key_; });
+    rebuild_index_ = false;
+}
+
 // called on process telegram, read from telegram
+// the index and the entities are used under the service lock, so an update from the web can't change them in between
 bool WebCustomEntityService::get_value(std::shared_ptr<const Telegram> telegram) {
     bool has_change = false;
-    EMSESP::webCustomEntityService.read([&](WebCustomEntity & webEntity) { customEntityItems = &webEntity.customEntityItems; });
+    EMSESP::webCustomEntityService.read([&](WebCustomEntity & webEntity) { has_change = get_value(webEntity.customEntityItems, telegram); });
+    if (has_change) {
+        publish();
+        return true;
+    }
+    return false;
+}
+
+bool WebCustomEntityService::get_value(std::list<CustomEntityItem> & entities, std::shared_ptr<const Telegram> telegram) {
+    if (rebuild_index_) {
+        build_index(entities);
+    }
+
+    uint32_t key = ((uint32_t)telegram->src << 16) | telegram->type_id;
+    auto     it  = std::lower_bound(entity_index_.begin(), entity_index_.end(), key, [](const CustomEntityIndex & e, const uint32_t k) { return e.key_ < k; });
+    if (it == entity_index_.end() || it->key_ != key) {
+        return false;
+    }
+
+    bool has_change = false;
     // read-length of BOOL, INT, UINT, SHORT, USHORT, ULONG, TIME
     const uint8_t len[] = {1, 1, 1, 2, 2, 3, 3};
-    for (auto & entity : *customEntityItems) {
-        if (entity.value_type == DeviceValueType::STRING && telegram->type_id == entity.type_id && telegram->src == entity.device_id
-            && telegram->offset == entity.offset) {
-            auto data = Helpers::data_to_hex(telegram->message_data, telegram->message_length);
-            if (entity.data != data) {
-                entity.data = data;
+    for (; it != entity_index_.end() && it->key_ == key; ++it) {
+        auto & entity = *it->item_;
+        if (entity.value_type == DeviceValueType::STRING && telegram->offset == entity.offset) {
+            // compare the raw data, the hex string is only made when it has changed
+            if (entity.data.empty() || entity.raw_data.size() != telegram->message_length
+                || memcmp(entity.raw_data.data(), telegram->message_data, telegram->message_length)) {
+                entity.raw_data.assign(telegram->message_data, telegram->message_data + telegram->message_length);
+                entity.data = Helpers::data_to_hex(telegram->message_data, telegram->message_length);
                 if (Mqtt::publish_single()) {
                     publish_single(entity);
                 } else if (EMSESP::mqtt_.get_publish_onchange(0)) {
@@ -554,8 +589,8 @@ bool WebCustomEntityService::get_value(std::shared_ptr<const Telegram> telegram)
                 }
             }
         }
-        if (entity.value_type != DeviceValueType::STRING && telegram->type_id == entity.type_id && telegram->src == entity.device_id
-            && telegram->offset <= entity.offset && (telegram->offset + telegram->message_length) >= (entity.offset + len[entity.value_type])) {
+        if (entity.value_type != DeviceValueType::STRING && telegram->offset <= entity.offset
+            && (telegram->offset + telegram->message_length) >= (entity.offset + len[entity.value_type])) {
             uint32_t value = 0;
             for (uint8_t i = 0; i < len[entity.value_type]; i++) {
                 value = (value << 8) + telegram->message_data[i + entity.offset - telegram->offset];
@@ -571,11 +606,7 @@ bool WebCustomEntityService::get_value(std::shared_ptr<const Telegram> telegram)
             // EMSESP::logger().debug("custom entity %s received with value %d", entity.name.c_str(), (int)entity.val);
         }
     }
-    if (has_change) {
-        publish();
-        return true;
-    }
-    return false;
+    return has_change;
 }
 
 } // namespace emsesp
@@ -38,6 +38,8 @@ class CustomEntityItem {
     bool        writeable;
     uint32_t    value;
     std::string data;
+
+    std::vector<uint8_t> raw_data; // telegram data of a string entity, compared before it is converted to hex
 };
 
 class WebCustomEntity {
@@ -66,6 +68,9 @@ class WebCustomEntityService : public StatefulService<WebCustomEntity> {
     void    ha_reset() {
         ha_registered_ = false;
     }
+    void index_reset() {
+        rebuild_index_ = true;
+    }
 
 
   private:
@@ -74,6 +79,17 @@ class WebCustomEntityService : public StatefulService<WebCustomEntity> {
 
     std::list<CustomEntityItem> * customEntityItems; // pointer to the list of entity items
     bool                          ha_registered_ = false;
+
+    // entities by source device and type id, so a telegram only looks at the entities reading it
+    struct CustomEntityIndex {
+        uint32_t           key_; // device_id << 16 | type_id
+        CustomEntityItem * item_;
+    };
+    std::vector<CustomEntityIndex> entity_index_;        // sorted by key, entities with the same key keep the list order
+    bool                           rebuild_index_ = true; // the entities have changed
+
+    void build_index(std::list<CustomEntityItem> & entities);
+    bool get_value(std::list<CustomEntityItem> & entities, std::shared_ptr<const Telegram> telegram);
 };
 
 } // namespace emsesp
@@ -32,25 +32,26 @@ WebLogService::WebLogService(AsyncWebServer * server, SecurityManager * security
     // for bring back the whole log - is a command, hence a POST
     server->on(FETCH_LOG_PATH, HTTP_POST, std::bind(&WebLogService::fetchLog, this, _1));
 
+    // download the binary bus capture
+    server->on(BUS_CAPTURE_PATH, HTTP_GET, securityManager->wrapRequest(std::bind(&WebLogService::busCapture, this, _1), AuthenticationPredicates::IS_ADMIN));
+
     server->addHandler(&setValues_);
     server->addHandler(&events_);
 }
 
-// start the log service with INFO level
+// start the log service with INFO level and a buffer for the default number of messages, so the boot messages are kept
 void WebLogService::begin() {
+    resize(MAX_LOG_MESSAGES);
     uuid::log::Logger::register_handler(this, uuid::log::Level::INFO);
 }
 
-// apply the user settings
+// apply the user settings, the buffer is sized for the message limit and freed if the log is off
 void WebLogService::start() {
     EMSESP::webSettingsService.read([&](WebSettings & settings) {
-        maximum_log_messages_ = settings.weblog_buffer;
-        limit_log_messages_   = maximum_log_messages_;
+        maximum_log_messages_ = std::min(std::max((size_t)1, (size_t)settings.weblog_buffer), maximum_log_messages_limit());
         compact_              = settings.weblog_compact;
         uuid::log::Logger::register_handler(this, (uuid::log::Level)settings.weblog_level);
-        if ((uuid::log::Level)settings.weblog_level == uuid::log::Level::OFF) {
-            log_messages_.clear();
-        }
+        resize((uuid::log::Level)settings.weblog_level == uuid::log::Level::OFF ? 0 : maximum_log_messages_);
     });
 }
 
@@ -66,26 +67,39 @@ void WebLogService::log_level(uuid::log::Level level) {
         },
         "local");
     uuid::log::Logger::register_handler(this, level);
-    if (level == uuid::log::Level::OFF) {
-        log_messages_.clear();
-    }
+    resize(level == uuid::log::Level::OFF ? 0 : maximum_log_messages_);
 }
 
 size_t WebLogService::num_log_messages() const {
-    return log_messages_.size();
+    std::lock_guard<std::mutex> lock(mutex_);
+    return log_message_id_ + 1 - first_id_;
 }
 
 size_t WebLogService::maximum_log_messages() const {
     return maximum_log_messages_;
 }
 
+// the number of typical messages the largest ring buffer holds
+size_t WebLogService::maximum_log_messages_limit() const {
+#ifndef EMSESP_STANDALONE
+    if (ESP.getPsramSize()) {
+        return LOG_BUFFER_SIZE_PSRAM / AVG_RECORD_SIZE;
+    }
+#endif
+    return LOG_BUFFER_SIZE / AVG_RECORD_SIZE;
+}
+
 void WebLogService::maximum_log_messages(size_t count) {
-    maximum_log_messages_ = std::max((size_t)1, count);
-    if (limit_log_messages_ > maximum_log_messages_) {
-        limit_log_messages_ = maximum_log_messages_;
+    count = std::min(std::max((size_t)1, count), maximum_log_messages_limit());
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        maximum_log_messages_ = count;
+        while (log_message_id_ + 1 - first_id_ > maximum_log_messages_) {
+            pop();
+        }
     }
-    while (log_messages_.size() > maximum_log_messages_) {
-        log_messages_.pop_front();
+    if (log_level() != uuid::log::Level::OFF) {
+        resize(count);
     }
     EMSESP::webSettingsService.update(
         [&](WebSettings & settings) {
@@ -109,25 +123,128 @@ void WebLogService::compact(bool compact) {
         "local");
 }
 
-WebLogService::QueuedLogMessage::QueuedLogMessage(unsigned long id, std::shared_ptr<uuid::log::Message> && content)
-    : id_(id)
-    , content_(std::move(content)) {
-}
+// reallocate the ring buffer for a number of typical messages, 0 frees it
+// the newest records that fit are kept. Without PSRAM the buffer is made smaller when the largest free heap block is small
+// if the allocation fails the old buffer and its records are kept
+void WebLogService::resize(const size_t messages) {
+    size_t size = messages ? std::max(messages * AVG_RECORD_SIZE, RECORD_HEADER_SIZE + MAX_TEXT_LENGTH) : 0;
 
-void WebLogService::operator<<(std::shared_ptr<uuid::log::Message> message) {
-#ifndef EMSESP_STANDALONE
-    size_t maxAlloc = ESP.getMaxAllocHeap();
-    if (limit_log_messages_ > 5 && maxAlloc < 46080) {
-        --limit_log_messages_;
-    } else if (limit_log_messages_ < maximum_log_messages_ && maxAlloc > 51200) {
-        ++limit_log_messages_;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (size == buffer_size_) {
+        return;
     }
+
+    uint8_t * buffer = nullptr;
+    if (size) {
+#ifndef EMSESP_STANDALONE
+        if (ESP.getPsramSize()) {
+            buffer = (uint8_t *)ps_malloc(size);
+        }
+        while (!buffer && size > RECORD_HEADER_SIZE + MAX_TEXT_LENGTH && ESP.getMaxAllocHeap() < size + LOG_HEAP_RESERVE) {
+            size = std::max(size / 2, RECORD_HEADER_SIZE + MAX_TEXT_LENGTH);
+        }
 #endif
-    while (log_messages_.size() >= limit_log_messages_) {
-        log_messages_.pop_front();
+        if (!buffer) {
+            buffer = (uint8_t *)malloc(size);
+        }
+        if (!buffer) {
+            return;
+        }
     }
 
-    log_messages_.emplace_back(++log_message_id_, std::move(message));
+    // drop the oldest records that don't fit, then copy the rest to the start of the new buffer
+    while (used_ > size) {
+        pop();
+    }
+    bool   sent     = log_message_id_tail_ >= log_message_id_;
+    size_t send_pos = (send_pos_ + buffer_size_ - tail_) % std::max(buffer_size_, (size_t)1);
+    if (buffer && used_) {
+        read(tail_, buffer, used_);
+    }
+    free(buffer_);
+
+    buffer_      = buffer;
+    buffer_size_ = size;
+    tail_        = 0;
+    head_        = size ? used_ % size : 0;
+    send_pos_    = sent ? head_ : send_pos; // records already shown are not sent again, unless they were dropped
+}
+
+// copy into the ring buffer at pos, wrapping around the end
+void WebLogService::write(size_t pos, const void * data, const size_t len) {
+    size_t n = std::min(len, buffer_size_ - pos);
+    memcpy(buffer_ + pos, data, n);
+    memcpy(buffer_, (const uint8_t *)data + n, len - n);
+}
+
+// copy from the ring buffer at pos, wrapping around the end
+void WebLogService::read(size_t pos, void * data, const size_t len) const {
+    size_t n = std::min(len, buffer_size_ - pos);
+    memcpy(data, buffer_ + pos, n);
+    memcpy((uint8_t *)data + n, buffer_, len - n);
+}
+
+// reads the header of the record at pos, returns the position of its text
+size_t WebLogService::read_record(size_t pos, LogRecord & record) const {
+    uint8_t header[RECORD_HEADER_SIZE];
+    read(pos, header, RECORD_HEADER_SIZE);
+    memcpy(&record.uptime_ms, header, 8);
+    memcpy(&record.length, header + 8, 2);
+    record.level    = header[10];
+    record.facility = header[11];
+    record.name     = header[12];
+    return (pos + RECORD_HEADER_SIZE) % buffer_size_;
+}
+
+// drop the oldest record, the mutex must be held
+void WebLogService::pop() {
+    LogRecord record;
+    read_record(tail_, record);
+    size_t len = RECORD_HEADER_SIZE + record.length;
+    tail_      = (tail_ + len) % buffer_size_;
+    used_ -= len;
+    first_id_++;
+}
+
+void WebLogService::operator<<(std::shared_ptr<uuid::log::Message> message) {
+    uint16_t length = std::min(message->text.size(), MAX_TEXT_LENGTH);
+    size_t   len    = RECORD_HEADER_SIZE + length;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!buffer_size_) {
+            return;
+        }
+
+        uint8_t name = 0;
+        while (name < names_.size() && names_[name] != message->name) {
+            name++;
+        }
+        if (name == names_.size()) {
+            if (names_.size() < UINT8_MAX) {
+                names_.push_back(message->name);
+            } else {
+                name = 0;
+            }
+        }
+
+        // make room, dropping the oldest records
+        while (used_ && (used_ + len > buffer_size_ || log_message_id_ + 1 - first_id_ >= maximum_log_messages_)) {
+            pop();
+        }
+
+        uint8_t header[RECORD_HEADER_SIZE];
+        memcpy(header, &message->uptime_ms, 8);
+        memcpy(header + 8, &length, 2);
+        header[10] = message->level;
+        header[11] = message->facility;
+        header[12] = name;
+        write(head_, header, RECORD_HEADER_SIZE);
+        write((head_ + RECORD_HEADER_SIZE) % buffer_size_, message->text.c_str(), length);
+        head_ = (head_ + len) % buffer_size_;
+        used_ += len;
+        log_message_id_++;
+    }
 
     EMSESP::esp8266React.getNTPSettingsService()->read([&](NTPSettings & settings) {
         if (!settings.enabled || (time(nullptr) < 1500000000L)) {
@@ -143,12 +260,12 @@ void WebLogService::operator<<(std::shared_ptr<uuid::log::Message> message) {
 }
 
 void WebLogService::loop() {
-    if (!events_.count() || log_messages_.empty()) {
+    if (!events_.count()) {
         return;
     }
 
     // see if we've advanced
-    if (log_messages_.back().id_ <= log_message_id_tail_) {
+    if (!rewind_ && log_message_id_tail_ >= log_message_id_) {
         return;
     }
 
@@ -158,12 +275,10 @@ void WebLogService::loop() {
     }
     last_transmit_ = uuid::get_uptime_ms();
 
-    // flush
-    for (const auto & message : log_messages_) {
-        if (message.id_ > log_message_id_tail_) {
-            log_message_id_tail_ = message.id_;
-            transmit(message);
-            return;
+    // flush, as long as the event source keeps up
+    for (size_t i = 0; i < MAX_TRANSMIT && events_.avgPacketsWaiting() < MAX_TRANSMIT; i++) {
+        if (!transmit_next()) {
+            break;
         }
     }
 }
@@ -171,43 +286,82 @@ void WebLogService::loop() {
 // convert time to real offset
 char * WebLogService::messagetime(char * out, const uint64_t t, const size_t bufsize) {
     if (!time_offset_) {
-        strlcpy(out, uuid::log::format_timestamp_ms(t, 3).c_str(), bufsize);
+        // same as uuid::log::format_timestamp_ms(t, 3), without the string
+        uint32_t s = t / 1000ULL;
+        snprintf(out, bufsize, "%03lu+%02u:%02u:%02u.%03u", (unsigned long)(s / 86400), (s / 3600) % 24, (s / 60) % 60, s % 60, (uint16_t)(t % 1000));
     } else {
         time_t t1 = time_offset_ + t / 1000ULL;
-        strftime(out, bufsize, "%F %T", localtime(&t1));
-        snprintf(out, bufsize, "%s.%03d", out, (uint16_t)(t % 1000));
+        size_t n  = strftime(out, bufsize, "%F %T", localtime(&t1));
+        snprintf(out + n, bufsize - n, ".%03d", (uint16_t)(t % 1000));
     }
     return out;
 }
 
-// send to web eventsource
-void WebLogService::transmit(const QueuedLogMessage & message) {
-    StaticJsonDocument<EMSESP_JSON_SIZE_MEDIUM> jsonDocument;
-    JsonObject                                  logEvent = jsonDocument.to<JsonObject>();
-    char                                        time_string[25];
+// send the record after the last one shown to web eventsource
+// the text is read straight from the ring buffer, the json only references it
+bool WebLogService::transmit_next() {
+    LogRecord     record;
+    const char *  name;
+    char          text[MAX_TEXT_LENGTH + 1];
+    unsigned long id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (rewind_ || log_message_id_tail_ + 1 < first_id_) {
+            // start again at the oldest record
+            rewind_              = false;
+            send_pos_            = tail_;
+            log_message_id_tail_ = first_id_ - 1;
+        }
+        if (log_message_id_tail_ >= log_message_id_) {
+            return false;
+        }
+        size_t pos = read_record(send_pos_, record);
+        read(pos, text, record.length);
+        text[record.length] = '\0';
+        send_pos_           = (pos + record.length) % buffer_size_;
+        id                  = ++log_message_id_tail_;
+        name                = names_[record.name];
+    }
+
+    StaticJsonDocument<EMSESP_JSON_SIZE_SMALL> jsonDocument;
+    JsonObject                                 logEvent = jsonDocument.to<JsonObject>();
+    char                                       time_string[25];
+    char                                       buffer[MAX_TEXT_LENGTH * 2 + 128];
 
-    logEvent["t"] = messagetime(time_string, message.content_->uptime_ms, sizeof(time_string));
-    logEvent["l"] = message.content_->level;
-    logEvent["i"] = message.id_;
-    logEvent["n"] = message.content_->name;
-    logEvent["m"] = message.content_->text;
+    logEvent["t"] = (const char *)messagetime(time_string, record.uptime_ms, sizeof(time_string));
+    logEvent["l"] = record.level;
+    logEvent["i"] = id;
+    logEvent["n"] = name;
+    logEvent["m"] = (const char *)text;
 
-    size_t len    = measureJson(jsonDocument);
-    char * buffer = new char[len + 1];
-    if (buffer) {
-        serializeJson(jsonDocument, buffer, len + 1);
-        events_.send(buffer, "message", message.id_);
+    if (measureJson(jsonDocument) < sizeof(buffer)) {
+        serializeJson(jsonDocument, buffer, sizeof(buffer));
+        events_.send(buffer, "message", id);
     }
-    delete[] buffer;
+    return true;
 }
 
 // send the complete log buffer to the API, not filtering on log level
-// done by resetting the pointer
+// done by rewinding to the oldest record
 void WebLogService::fetchLog(AsyncWebServerRequest * request) {
-    log_message_id_tail_ = 0;
+    rewind_ = true;
     request->send(200);
 }
 
+// sends a copy of the bus capture ring buffer as a binary file
+void WebLogService::busCapture(AsyncWebServerRequest * request) {
+    auto capture = std::make_shared<std::vector<uint8_t>>(EMSESP::buscapture_.snapshot());
+
+    AsyncWebServerResponse * response =
+        request->beginResponse("application/octet-stream", capture->size(), [capture](uint8_t * buffer, size_t maxLen, size_t index) -> size_t {
+            size_t len = std::min(maxLen, capture->size() - index);
+            memcpy(buffer, capture->data() + index, len);
+            return len;
+        });
+    response->addHeader("Content-Disposition", "attachment; filename=buscapture.bin");
+    request->send(response);
+}
+
 // sets the values like level after a POST
 void WebLogService::setValues(AsyncWebServerRequest * request, JsonVariant & json) {
     if (!json.is<JsonObject>()) {
@@ -219,7 +373,7 @@ void WebLogService::setValues(AsyncWebServerRequest * request, JsonVariant & jso
     uuid::log::Level level = body["level"];
     log_level(level);
 
-    uint8_t max_messages = body["max_messages"];
+    uint16_t max_messages = body["max_messages"];
     maximum_log_messages(max_messages);
 
     bool comp = body["compact"];
@@ -233,8 +387,9 @@ void WebLogService::getValues(AsyncWebServerRequest * request) {
     auto *     response  = new AsyncJsonResponse(false, EMSESP_JSON_SIZE_SMALL);
     JsonObject root      = response->getRoot();
     root["level"]        = log_level();
-    root["max_messages"] = maximum_log_messages();
-    root["compact"]      = compact();
+    root["max_messages"]       = maximum_log_messages();
+    root["max_messages_limit"] = maximum_log_messages_limit();
+    root["compact"]            = compact();
     response->setLength();
     request->send(response);
 }
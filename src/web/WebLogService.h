@@ -22,13 +22,24 @@
 #define EVENT_SOURCE_LOG_PATH "/es/log"
 #define FETCH_LOG_PATH "/rest/fetchLog"
 #define LOG_SETTINGS_PATH "/rest/logSettings"
+#define BUS_CAPTURE_PATH "/rest/busCapture"
 
 namespace emsesp {
 
+// log records are kept in a byte ring buffer, oldest first, each with a header of
+// uptime (8 bytes), text length (2), level (1), facility (1) and logger name index (1), followed by the text
+// the record id is not stored, records are numbered consecutively from the oldest one
 class WebLogService : public uuid::log::Handler {
   public:
-    static constexpr size_t MAX_LOG_MESSAGES = 50;
-    static constexpr size_t REFRESH_SYNC     = 50;
+    static constexpr size_t MAX_LOG_MESSAGES      = 50;
+    static constexpr size_t LOG_BUFFER_SIZE       = 16384;  // bytes, largest buffer
+    static constexpr size_t LOG_BUFFER_SIZE_PSRAM = 262144; // bytes, largest buffer if the board has PSRAM
+    static constexpr size_t LOG_HEAP_RESERVE      = 16384;  // heap block left over after allocating the buffer without PSRAM, else it is made smaller
+    static constexpr size_t MAX_TEXT_LENGTH       = 256;    // longer messages are truncated
+    static constexpr size_t RECORD_HEADER_SIZE    = 13;
+    static constexpr size_t AVG_RECORD_SIZE       = 64;     // bytes, header and a typical message, the message limit is capped to what fits in the buffer
+    static constexpr size_t REFRESH_SYNC          = 50;
+    static constexpr size_t MAX_TRANSMIT          = 8; // messages sent to the event source per refresh
 
     WebLogService(AsyncWebServer * server, SecurityManager * securityManager);
 
@@ -37,6 +48,7 @@ class WebLogService : public uuid::log::Handler {
     uuid::log::Level log_level() const;
     void             log_level(uuid::log::Level level);
     size_t           maximum_log_messages() const;
+    size_t           maximum_log_messages_limit() const;
     size_t           num_log_messages() const;
     void             maximum_log_messages(size_t count);
     bool             compact() const;
@@ -48,19 +60,23 @@ class WebLogService : public uuid::log::Handler {
   private:
     AsyncEventSource events_;
 
-    class QueuedLogMessage {
-      public:
-        QueuedLogMessage(unsigned long id, std::shared_ptr<uuid::log::Message> && content);
-        ~QueuedLogMessage() = default;
-
-        unsigned long                                   id_;      // Sequential identifier for this log message
-        struct timeval                                  time_;    // Time message was received
-        const std::shared_ptr<const uuid::log::Message> content_; // Log message content
+    struct LogRecord {
+        uint64_t uptime_ms;
+        uint16_t length;
+        uint8_t  level;
+        uint8_t  facility;
+        uint8_t  name;
     };
 
-    void transmit(const QueuedLogMessage & message);
-    void fetchLog(AsyncWebServerRequest * request);
-    void getValues(AsyncWebServerRequest * request);
+    void   resize(const size_t messages);
+    void   pop();
+    void   write(size_t pos, const void * data, const size_t len);
+    void   read(size_t pos, void * data, const size_t len) const;
+    size_t read_record(size_t pos, LogRecord & record) const;
+    bool   transmit_next();
+    void   fetchLog(AsyncWebServerRequest * request);
+    void   getValues(AsyncWebServerRequest * request);
+    void   busCapture(AsyncWebServerRequest * request);
 
     char * messagetime(char * out, const uint64_t t, const size_t bufsize);
 
@@ -68,14 +84,22 @@ class WebLogService : public uuid::log::Handler {
 
     AsyncCallbackJsonWebHandler setValues_; // for POSTs
 
-    uint64_t                     last_transmit_        = 0;                // Last transmit time
-    size_t                       maximum_log_messages_ = MAX_LOG_MESSAGES; // Maximum number of log messages to buffer before they are output
-    size_t                       limit_log_messages_   = 1;                // dynamic limit
-    unsigned long                log_message_id_       = 0;                // The next identifier to use for queued log messages
-    unsigned long                log_message_id_tail_  = 0;                // last event shown on the screen after fetch
-    std::deque<QueuedLogMessage> log_messages_;                            // Queued log messages, in the order they were received
-    time_t                       time_offset_ = 0;
-    bool                         compact_     = true;
+    uint8_t *                 buffer_               = nullptr;          // the log records, sized from the message limit, none if the log is off
+    size_t                    buffer_size_          = 0;                // bytes
+    size_t                    head_                 = 0;                // where the next record is written
+    size_t                    tail_                 = 0;                // oldest record
+    size_t                    used_                 = 0;                // bytes in use
+    std::vector<const char *> names_;                                   // logger names, referenced by index from the records
+    mutable std::mutex        mutex_;                                   // messages can be logged from any task
+    uint64_t                  last_transmit_        = 0;                // Last transmit time
+    size_t                    maximum_log_messages_ = MAX_LOG_MESSAGES; // Maximum number of log messages to buffer before they are output
+    unsigned long             log_message_id_       = 0;                // The identifier of the newest log message
+    unsigned long             first_id_             = 1;                // The identifier of the oldest log message in the buffer
+    unsigned long             log_message_id_tail_  = 0;                // last event shown on the screen after fetch
+    size_t                    send_pos_             = 0;                // record after the last event shown
+    bool                      rewind_               = false;            // send the whole buffer again
+    time_t                    time_offset_          = 0;
+    bool                      compact_              = true;
 };
 
 } // namespace emsesp
@@ -87,8 +87,11 @@ StateUpdateResult WebScheduler::update(JsonObject & root, WebScheduler & webSche
             si.name   = schedule["name"].as<std::string>();
 
             // calculated elapsed minutes
-            si.elapsed_min = Helpers::string2minutes(si.time);
-            si.retry_cnt   = 0xFF; // no startup retries
+            si.elapsed_min     = Helpers::string2minutes(si.time);
+            si.retry_cnt       = 0xFF; // no startup retries
+            si.cmd_pos         = 0;    // resolved on the first call
+            si.cmd_device_type = EMSdevice::DeviceType::UNKNOWN;
+            si.cmd_id          = -1;
 
             webScheduler.scheduleItems.push_back(si); // add to list
             if (!webScheduler.scheduleItems.back().name.empty()) {
@@ -103,6 +106,7 @@ StateUpdateResult WebScheduler::update(JsonObject & root, WebScheduler & webSche
             }
         }
     }
+    EMSESP::webSchedulerService.schedule_changed(); // the list is complete, loop() rebuilds the events under the same lock
     EMSESP::webSchedulerService.publish(true);
     return StateUpdateResult::CHANGED;
 }
@@ -332,6 +336,52 @@ bool WebSchedulerService::command(const char * cmd, const char * data) {
     snprintf(command_str, sizeof(command_str), "/api/%s", cmd);
     uint8_t return_code = Command::process(command_str, true, input, output); // admin set
 
+    return command_result(cmd, data, return_code, output);
+}
+
+// execute a schedule item, the device, hc and command name are taken from the path once and then called directly
+// paths the API parser would treat differently, and data referring to another entity, still go through it
+bool WebSchedulerService::command(ScheduleItem & scheduleItem) {
+    const char * cmd  = scheduleItem.cmd.c_str();
+    const char * data = scheduleItem.value.c_str();
+
+    if (scheduleItem.cmd_pos == 0) {
+        scheduleItem.cmd_pos = CMD_UNRESOLVED;
+        const char * device_end = strchr(cmd, '/');
+        uint8_t      slashes    = 0;
+        bool         valid      = device_end && device_end != cmd && strlen(cmd) < CMD_UNRESOLVED && !strpbrk(cmd, "?=&");
+        for (const char * p = cmd; valid && *p; p++) {
+            if (*p == '/' && (++slashes > 3 || p[1] == '/' || p[1] == '\0')) {
+                valid = false;
+            }
+        }
+        if (valid && strlen(device_end + 1) < 50) {
+            char device_s[20];
+            strlcpy(device_s, cmd, std::min(sizeof(device_s), (size_t)(device_end - cmd + 1)));
+            int8_t       id          = -1;
+            uint8_t      device_type = EMSdevice::device_name_2_device_type(device_s);
+            const char * command_p   = Command::parse_command_string(device_end + 1, id);
+            if (device_type != EMSdevice::DeviceType::UNKNOWN && command_p) {
+                scheduleItem.cmd_pos         = command_p - cmd;
+                scheduleItem.cmd_device_type = device_type;
+                scheduleItem.cmd_id          = id;
+            }
+        }
+    }
+
+    if (scheduleItem.cmd_pos == CMD_UNRESOLVED || strchr(data, '/') || !Command::device_has_commands(scheduleItem.cmd_device_type)) {
+        return command(cmd, data);
+    }
+
+    StaticJsonDocument<EMSESP_JSON_SIZE_SMALL> doc_output; // only for commands without output
+    JsonObject                                 output      = doc_output.to<JsonObject>();
+    uint8_t                                    return_code = Command::call(scheduleItem.cmd_device_type, cmd + scheduleItem.cmd_pos, data, true, scheduleItem.cmd_id, output);
+
+    return command_result(cmd, data, return_code, output);
+}
+
+// log the result of a scheduled command, the output of a query is published
+bool WebSchedulerService::command_result(const char * cmd, const char * data, const uint8_t return_code, const JsonObject & output) {
     if (return_code == CommandRet::OK) {
         EMSESP::logger().debug("Scheduled command %s with data %s successfully", cmd, data);
         if (strlen(data) == 0 && output.size()) {
@@ -355,61 +405,128 @@ bool WebSchedulerService::command(const char * cmd, const char * data) {
     return false;
 }
 
+// timers fire every elapsed_min minutes of uptime
+void WebSchedulerService::add_timer(ScheduleItem * scheduleItem, const uint16_t pos, const uint32_t uptime_min) {
+    timer_events_.push_back({(uptime_min / scheduleItem->elapsed_min + 1) * scheduleItem->elapsed_min, pos, scheduleItem});
+    std::push_heap(timer_events_.begin(), timer_events_.end(), std::greater<ScheduleEvent>());
+}
+
+// weekday events fire at elapsed_min local time on the days set in flags (bit 0 is Sunday)
+// the next one is found with mktime, so it follows daylight saving changes
+void WebSchedulerService::add_clock(ScheduleItem * scheduleItem, const uint16_t pos, const time_t now, const bool this_minute) {
+    if (!(scheduleItem->flags & 0x7F) || scheduleItem->elapsed_min >= 24 * 60) {
+        return;
+    }
+    tm       today = *localtime(&now);
+    uint32_t from  = now / 60 + (this_minute ? 0 : 1);
+    for (uint8_t d = 0; d <= 7; d++) {
+        tm day       = today;
+        day.tm_mday  = today.tm_mday + d;
+        day.tm_hour  = scheduleItem->elapsed_min / 60;
+        day.tm_min   = scheduleItem->elapsed_min % 60;
+        day.tm_sec   = 0;
+        day.tm_isdst = -1;
+        time_t fire  = mktime(&day); // also sets the weekday
+        if ((scheduleItem->flags & (1 << day.tm_wday)) && (uint32_t)(fire / 60) >= from) {
+            clock_events_.push_back({(uint32_t)(fire / 60), pos, scheduleItem});
+            std::push_heap(clock_events_.begin(), clock_events_.end(), std::greater<ScheduleEvent>());
+            return;
+        }
+    }
+}
+
+// put all schedule items in the timer and clock heaps, weekday events only once the clock is set
+// called with the service locked
+void WebSchedulerService::build_events(std::list<ScheduleItem> & items, const bool this_minute) {
+    timer_events_.clear();
+    clock_events_.clear();
+    startup_items_.clear();
+
+    uint32_t uptime_min = uuid::get_uptime_sec() / 60;
+    time_t   now        = time(nullptr);
+    uint16_t pos        = 0;
+    for (ScheduleItem & scheduleItem : items) {
+        if (scheduleItem.flags == SCHEDULEFLAG_SCHEDULE_TIMER) {
+            if (scheduleItem.elapsed_min == 0) {
+                startup_items_.push_back(&scheduleItem);
+            } else {
+                add_timer(&scheduleItem, pos, uptime_min);
+            }
+        } else if (last_clock_) {
+            add_clock(&scheduleItem, pos, now, this_minute);
+        }
+        pos++;
+    }
+    rebuild_ = false;
+}
+
 // process any scheduled jobs
-// checks on the minute and at startup
+// the events point into the schedule items, so they are built and run under the service lock and an update from the web can't free them in between
 void WebSchedulerService::loop() {
-    // initialize static value on startup
-    static int8_t   last_tm_min     = -1; // invalid value also used for startup commands
-    static uint32_t last_uptime_min = 0;
+    EMSESP::webSchedulerService.read([&](WebScheduler & webScheduler) { loop(webScheduler.scheduleItems); });
+}
 
-    // get list of scheduler events and exit if it's empty
-    EMSESP::webSchedulerService.read([&](WebScheduler & webScheduler) { scheduleItems = &webScheduler.scheduleItems; });
-    if (scheduleItems->size() == 0) {
-        return;
+// only the first event of each heap is checked, on the minute, the start-up commands run at the first call
+void WebSchedulerService::loop(std::list<ScheduleItem> & items) {
+    if (rebuild_) {
+        build_events(items, false);
     }
 
     // check startup commands
-    if (last_tm_min == -1) {
-        for (ScheduleItem & scheduleItem : *scheduleItems) {
-            if (scheduleItem.active && scheduleItem.flags == SCHEDULEFLAG_SCHEDULE_TIMER && scheduleItem.elapsed_min == 0) {
-                scheduleItem.retry_cnt = command(scheduleItem.cmd.c_str(), scheduleItem.value.c_str()) ? 0xFF : 0;
+    if (startup_) {
+        for (ScheduleItem * scheduleItem : startup_items_) {
+            if (scheduleItem->active) {
+                scheduleItem->retry_cnt = command(*scheduleItem) ? 0xFF : 0;
             }
         }
-        last_tm_min = 0; // startup done, now use for RTC
+        startup_ = false;
     }
 
     // check timer every minute, sync to EMS-ESP clock
     uint32_t uptime_min = uuid::get_uptime_sec() / 60;
-    if (last_uptime_min != uptime_min) {
-        for (ScheduleItem & scheduleItem : *scheduleItems) {
-            // retry startup commands not yet executed
-            if (scheduleItem.active && scheduleItem.flags == SCHEDULEFLAG_SCHEDULE_TIMER && scheduleItem.elapsed_min == 0
-                && scheduleItem.retry_cnt < MAX_STARTUP_RETRIES) {
-                scheduleItem.retry_cnt = command(scheduleItem.cmd.c_str(), scheduleItem.value.c_str()) ? 0xFF : scheduleItem.retry_cnt + 1;
+    if (last_minute_ != uptime_min) {
+        last_minute_ = uptime_min;
+        // retry startup commands not yet executed
+        for (ScheduleItem * scheduleItem : startup_items_) {
+            if (scheduleItem->active && scheduleItem->retry_cnt < MAX_STARTUP_RETRIES) {
+                scheduleItem->retry_cnt = command(*scheduleItem) ? 0xFF : scheduleItem->retry_cnt + 1;
             }
-            // scheduled timer commands
-            if (scheduleItem.active && scheduleItem.flags == SCHEDULEFLAG_SCHEDULE_TIMER && scheduleItem.elapsed_min > 0
-                && (uptime_min % scheduleItem.elapsed_min == 0)) {
-                command(scheduleItem.cmd.c_str(), scheduleItem.value.c_str());
+        }
+        // scheduled timer commands
+        while (!timer_events_.empty() && timer_events_.front().next_ <= uptime_min) {
+            std::pop_heap(timer_events_.begin(), timer_events_.end(), std::greater<ScheduleEvent>());
+            ScheduleEvent event = timer_events_.back();
+            timer_events_.pop_back();
+            if (event.item_->active) {
+                command(*event.item_);
             }
+            add_timer(event.item_, event.pos_, uptime_min);
         }
-        last_uptime_min = uptime_min;
     }
 
-    // check calender, sync to RTC, only execute if year is valid
+    // check calendar, sync to RTC, only once the clock is set (year 2021 or later)
     time_t now = time(nullptr);
-    tm *   tm  = localtime(&now);
-    if (tm->tm_min != last_tm_min && tm->tm_year > 120) {
-        // find the real dow and minute from RTC
-        uint8_t  real_dow = 1 << tm->tm_wday; // 1 is Sunday
-        uint16_t real_min = tm->tm_hour * 60 + tm->tm_min;
-
-        for (const ScheduleItem & scheduleItem : *scheduleItems) {
-            if (scheduleItem.active && (real_dow & scheduleItem.flags) && real_min == scheduleItem.elapsed_min) {
-                command(scheduleItem.cmd.c_str(), scheduleItem.value.c_str());
-            }
+    if (now < 1609459200) {
+        return;
+    }
+    uint32_t clock_min = now / 60;
+    if (clock_min == last_clock_) {
+        return;
+    }
+    // first valid time or the clock was adjusted, find the next events again
+    bool jumped = !last_clock_ || clock_min < last_clock_ || clock_min > last_clock_ + 2;
+    last_clock_ = clock_min;
+    if (jumped) {
+        build_events(items, true);
+    }
+    while (!clock_events_.empty() && clock_events_.front().next_ <= clock_min) {
+        std::pop_heap(clock_events_.begin(), clock_events_.end(), std::greater<ScheduleEvent>());
+        ScheduleEvent event = clock_events_.back();
+        clock_events_.pop_back();
+        if (event.item_->active) {
+            command(*event.item_);
         }
-        last_tm_min = tm->tm_min;
+        add_clock(event.item_, event.pos_, now, false);
     }
 }
 
@@ -24,6 +24,7 @@
 
 #define SCHEDULEFLAG_SCHEDULE_TIMER 0x80 // 7th bit for Timer
 #define MAX_STARTUP_RETRIES 3            // retry the start-up commands x times
+#define CMD_UNRESOLVED 0xFF              // schedule command can't be called directly
 
 namespace emsesp {
 
@@ -37,6 +38,9 @@ class ScheduleItem {
     std::string value;
     std::string name;
     uint8_t     retry_cnt;
+    uint8_t     cmd_pos;         // start of the command name in cmd once resolved, 0 if not yet, CMD_UNRESOLVED to use the full parser
+    uint8_t     cmd_device_type; // resolved from cmd
+    int8_t      cmd_id;          // hc/wwc from cmd
 };
 
 class WebScheduler {
@@ -61,18 +65,44 @@ class WebSchedulerService : public StatefulService<WebScheduler> {
     void ha_reset() {
         ha_registered_ = false;
     }
+    void schedule_changed() {
+        rebuild_ = true;
+    }
 
 // make all functions public so we can test in the debug and standalone mode
 #ifndef EMSESP_STANDALONE
   private:
 #endif
     bool command(const char * cmd, const char * data);
+    bool command(ScheduleItem & scheduleItem);
+    bool command_result(const char * cmd, const char * data, const uint8_t return_code, const JsonObject & output);
+    void loop(std::list<ScheduleItem> & items);
+    void build_events(std::list<ScheduleItem> & items, const bool this_minute);
+    void add_timer(ScheduleItem * scheduleItem, const uint16_t pos, const uint32_t uptime_min);
+    void add_clock(ScheduleItem * scheduleItem, const uint16_t pos, const time_t now, const bool this_minute);
 
     HttpEndpoint<WebScheduler>  _httpEndpoint;
     FSPersistence<WebScheduler> _fsPersistence;
 
     std::list<ScheduleItem> * scheduleItems; // pointer to the list of schedule events
     bool                      ha_registered_ = false;
+
+    // min-heaps of the next minute each item fires, so the loop only looks at the first one
+    struct ScheduleEvent {
+        uint32_t       next_; // minute of uptime for timers, minute since epoch for weekday events
+        uint16_t       pos_;  // position in the list, items firing in the same minute keep the list order
+        ScheduleItem * item_;
+        bool           operator>(const ScheduleEvent & other) const {
+            return next_ > other.next_ || (next_ == other.next_ && pos_ > other.pos_);
+        }
+    };
+    std::vector<ScheduleEvent>  timer_events_;
+    std::vector<ScheduleEvent>  clock_events_;
+    std::vector<ScheduleItem *> startup_items_;      // timers with 0 minutes, run once at start
+    bool                        rebuild_     = true; // the schedule has changed
+    bool                        startup_     = true; // the start-up commands are not run yet
+    uint32_t                    last_minute_ = 0;    // last minute of uptime checked
+    uint32_t                    last_clock_  = 0;    // last clock minute checked, 0 if the clock is not set
 };
 
 } // namespace emsesp
@@ -46,6 +46,7 @@ void WebSettings::read(WebSettings & settings, JsonObject & root) {
     root["syslog_mark_interval"]  = settings.syslog_mark_interval;
     root["syslog_host"]           = settings.syslog_host;
     root["syslog_port"]           = settings.syslog_port;
+    root["syslog_tcp"]            = settings.syslog_tcp;
     root["shower_timer"]          = settings.shower_timer;
     root["shower_alert"]          = settings.shower_alert;
     root["shower_alert_coldshot"] = settings.shower_alert_coldshot;
@@ -54,6 +55,7 @@ void WebSettings::read(WebSettings & settings, JsonObject & root) {
     root["tx_gpio"]               = settings.tx_gpio;
     root["dallas_gpio"]           = settings.dallas_gpio;
     root["dallas_parasite"]       = settings.dallas_parasite;
+    root["dallas_budget"]         = settings.dallas_budget;
     root["led_gpio"]              = settings.led_gpio;
     root["hide_led"]              = settings.hide_led;
     root["low_clock"]             = settings.low_clock;
@@ -162,14 +164,15 @@ StateUpdateResult WebSettings::update(JsonObject & root, WebSettings & settings)
     prev                 = settings.syslog_port;
     settings.syslog_port = root["syslog_port"] | EMSESP_DEFAULT_SYSLOG_PORT;
     check_flag(prev, settings.syslog_port, ChangeFlags::SYSLOG);
+    prev                = settings.syslog_tcp;
+    settings.syslog_tcp = root["syslog_tcp"] | EMSESP_DEFAULT_SYSLOG_TCP;
+    check_flag(prev, settings.syslog_tcp, ChangeFlags::SYSLOG);
 
-#ifndef EMSESP_STANDALONE
     String old_syslog_host = settings.syslog_host;
     settings.syslog_host   = root["syslog_host"] | EMSESP_DEFAULT_SYSLOG_HOST;
     if (old_syslog_host != settings.syslog_host) {
         add_flags(ChangeFlags::SYSLOG);
     }
-#endif
 
     // button
     prev                  = settings.pbutton_gpio;
@@ -183,6 +186,9 @@ StateUpdateResult WebSettings::update(JsonObject & root, WebSettings & settings)
     prev                     = settings.dallas_parasite;
     settings.dallas_parasite = root["dallas_parasite"] | EMSESP_DEFAULT_DALLAS_PARASITE;
     check_flag(prev, settings.dallas_parasite, ChangeFlags::SENSOR);
+    prev                   = settings.dallas_budget;
+    settings.dallas_budget = root["dallas_budget"] | EMSESP_DEFAULT_DALLAS_BUDGET;
+    check_flag(prev, settings.dallas_budget, ChangeFlags::SENSOR);
 
     // shower
     prev                  = settings.shower_timer;
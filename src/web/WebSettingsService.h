@@ -42,11 +42,13 @@ class WebSettings {
     uint32_t syslog_mark_interval;
     String   syslog_host;
     uint16_t syslog_port;
+    bool     syslog_tcp;
     bool     trace_raw;
     uint8_t  rx_gpio;
     uint8_t  tx_gpio;
     uint8_t  dallas_gpio;
     bool     dallas_parasite;
+    uint8_t  dallas_budget;
     uint8_t  led_gpio;
     bool     hide_led;
     bool     low_clock;
@@ -61,7 +63,7 @@ class WebSettings {
     uint8_t  bool_dashboard;
     uint8_t  enum_format;
     int8_t   weblog_level;
-    uint8_t  weblog_buffer;
+    uint16_t weblog_buffer;
     bool     weblog_compact;
     bool     fahrenheit;
 